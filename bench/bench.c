@@ -0,0 +1,200 @@
+/*
+ * bench.c - cycle accurate benchmark of the firmware image under simavr
+ *
+ * \author Simeon Neykov
+ *
+ * Build and run:	make -C bench		(needs avr-gcc, avr-libc and libsimavr)
+ * Use:				./bench [-c label] [-n] firmware.elf scenario.txt [scenario.txt ...]
+ *
+ * - The ELF built by the Makefile runs on a simulated ATmega328P at 16MHz
+ * - UART0 output is counted (the backpack is not modeled here, see host/ for the screen model)
+ * - Port C pins are driven from the scenario, the same format as the host replay scripts:
+ *		"<ms> <PINC hex>"	port C levels from this time on (idle 1F)
+ *		"mark <ms>"			start of the measured window, reset (0) if omitted
+ *		"end <ms>"			end of the run
+ * - Measured: cycles from the mark to the last UART byte, the same in ms and the number of UART bytes
+ * - Output: one CSV line per scenario, "label,scenario,cycles,ms,uart_bytes", the label is e.g. the commit
+ *		-c label	first column, default "-"
+ *		-n			no CSV header line (to append to a history file)
+ *
+ * Not run yet: written against the libsimavr API but not built, there is no history.csv baseline so far.
+ * The first run on a machine with avr-gcc and libsimavr is to record it (make history).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libgen.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_irq.h>
+#include <simavr/avr_uart.h>
+#include <simavr/avr_ioport.h>
+
+#define BENCH_F_CPU			16000000UL
+#define BENCH_IDLE_PINC		0x1F
+#define BENCH_MAX_EVENTS	1024
+#define BENCH_PORTC_PINS	5		///< PC0 .. PC4 are the inputs driven by the scenario, PC5 is the LED output
+
+typedef struct {
+	avr_cycle_count_t at;
+	unsigned char pinc;
+} Event;
+
+static Event events[BENCH_MAX_EVENTS];
+static unsigned int event_count;
+static avr_cycle_count_t mark;
+static avr_cycle_count_t end;
+
+static avr_t *avr;
+static unsigned long uart_bytes;
+static avr_cycle_count_t uart_last;
+
+static avr_cycle_count_t ms_to_cycles(unsigned long ms)
+{
+	return (avr_cycle_count_t)ms * (BENCH_F_CPU / 1000);
+}
+
+static int scenario_load(const char *path)
+{
+	char line[128];
+	unsigned long ms;
+	unsigned int pinc;
+	FILE *file = fopen(path, "r");
+
+	if (!file)
+	{
+		perror(path);
+		return -1;
+	}
+	event_count = 0;
+	mark = 0;
+	end = 0;
+	while (fgets(line, sizeof(line), file))
+	{
+		if (sscanf(line, "mark %lu", &ms) == 1) mark = ms_to_cycles(ms);
+		else if (sscanf(line, "end %lu", &ms) == 1) end = ms_to_cycles(ms);
+		else if (sscanf(line, "%lu %x", &ms, &pinc) == 2)
+		{
+			if (event_count == BENCH_MAX_EVENTS)
+			{
+				fprintf(stderr, "%s: too many events\n", path);
+				fclose(file);
+				return -1;
+			}
+			events[event_count].at = ms_to_cycles(ms);
+			events[event_count].pinc = (unsigned char)pinc;
+			event_count++;
+		}
+	}
+	fclose(file);
+	if (!end)
+	{
+		fprintf(stderr, "%s: no \"end\" line\n", path);
+		return -1;
+	}
+	return 0;
+}
+
+static void uart_output(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	if (avr->cycle < mark) return;
+	uart_bytes++;
+	uart_last = avr->cycle;
+}
+
+static void portc_drive(unsigned char pinc)
+{
+	for (int pin = 0; pin < BENCH_PORTC_PINS; pin++)
+	{
+		avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('C'), pin), (pinc >> pin) & 1);
+	}
+}
+
+static int scenario_run(elf_firmware_t *firmware)
+{
+	unsigned int next = 0;
+	uint32_t flags = 0;
+	int state = cpu_Running;
+
+	avr = avr_make_mcu_by_name(firmware->mmcu);
+	if (!avr)
+	{
+		fprintf(stderr, "unknown MCU %s\n", firmware->mmcu);
+		return -1;
+	}
+	avr_init(avr);
+	avr_load_firmware(avr, firmware);
+
+	// count the bytes only, do not echo them on stdout
+	avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+	flags &= ~AVR_UART_FLAG_STDIO;
+	avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), uart_output, NULL);
+
+	uart_bytes = 0;
+	uart_last = mark;
+	portc_drive(BENCH_IDLE_PINC);
+	while ((avr->cycle < end) && (state != cpu_Done) && (state != cpu_Crashed))
+	{
+		while ((next < event_count) && (events[next].at <= avr->cycle)) portc_drive(events[next++].pinc);
+		state = avr_run(avr);
+	}
+	avr_terminate(avr);
+	return (state == cpu_Crashed) ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *label = "-";
+	const char *elf = NULL;
+	int header = 1;
+	int status = 0;
+	int i;
+	elf_firmware_t firmware;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-c") && (i + 1 < argc)) label = argv[++i];
+		else if (!strcmp(argv[i], "-n")) header = 0;
+		else break;
+	}
+	if (argc - i < 2)
+	{
+		fprintf(stderr, "usage: %s [-c label] [-n] firmware.elf scenario.txt [scenario.txt ...]\n", argv[0]);
+		return 2;
+	}
+	elf = argv[i++];
+
+	memset(&firmware, 0, sizeof(firmware));
+	if (elf_read_firmware(elf, &firmware) != 0)
+	{
+		fprintf(stderr, "%s: cannot load\n", elf);
+		return 1;
+	}
+	strcpy(firmware.mmcu, "atmega328p");
+	firmware.frequency = BENCH_F_CPU;
+
+	if (header) printf("label,scenario,cycles,ms,uart_bytes\n");
+	for (; i < argc; i++)
+	{
+		char name[128];
+		char *dot;
+		avr_cycle_count_t cycles;
+
+		if (scenario_load(argv[i]) || scenario_run(&firmware))
+		{
+			fprintf(stderr, "%s: failed\n", argv[i]);
+			status = 1;
+			continue;
+		}
+		snprintf(name, sizeof(name), "%s", argv[i]);
+		dot = strrchr(name, '.');
+		if (dot) *dot = 0;
+		cycles = uart_last - mark;
+		printf("%s,%s,%llu,%.3f,%lu\n", label, basename(name), (unsigned long long)cycles,
+			cycles * 1000.0 / BENCH_F_CPU, uart_bytes);
+		fflush(stdout);
+	}
+	return status;
+}
@@ -0,0 +1,16 @@
+/*
+ * avr/interrupt.h - host build replacement
+ *
+ * \author Simeon Neykov
+ *
+ * Interrupts are not simulated, ISRs are compiled as plain functions.
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#define ISR(vector)		void vector(void)
+#define sei()
+#define cli()
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
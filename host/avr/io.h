@@ -0,0 +1,43 @@
+/*
+ * avr/io.h - host build replacement
+ *
+ * \author Simeon Neykov
+ *
+ * MCU registers are plain variables of the simulator (hostsim.c). The firmware accesses the registers
+ * with a side effect (UART0 transmitter, port C inputs, Timer1 count) through the macros of serialGLCD/hal.h,
+ * the build defines HAL_HOST and hostsim.c implements them with the simulated devices.
+ */
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+extern volatile uint8_t UDR0, UCSR0A, UCSR0B, UCSR0C, UBRR0H, UBRR0L;
+extern volatile uint8_t PINB, PINC, PIND, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD;
+extern volatile uint8_t TCCR0A, TCCR0B, OCR0A, TIMSK0;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1, PCICR, PCMSK1, SREG;
+extern volatile uint16_t TCNT1;
+
+#define U2X0		1
+#define UDRE0		5
+#define UPM00		4
+#define UPM01		5
+#define USBS0		3
+#define UCSZ00		1
+#define RXEN0		4
+#define TXEN0		3
+#define WGM01		1
+#define CS00		0
+#define CS01		1
+#define OCIE0A		1
+#define CS10		0
+#define CS11		1
+#define CS12		2
+#define TOIE1		0
+#define TOV1		0
+#define PCIE1		1
+#define PD0			0
+#define PD1			1
+
+#endif /* HOST_AVR_IO_H_ */
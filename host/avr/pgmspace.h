@@ -0,0 +1,17 @@
+/*
+ * avr/pgmspace.h - host build replacement
+ *
+ * \author Simeon Neykov
+ *
+ * One address space on the host, PROGMEM data stays where the compiler puts it and is read directly.
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#define PROGMEM
+#define pgm_read_byte(address)	(*(const unsigned char *)(address))
+#define pgm_read_word(address)	(*(const unsigned short *)(address))
+#define pgm_read_ptr(address)	(*(void * const *)(address))
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
@@ -0,0 +1,611 @@
+/*
+ * hostsim.c - deterministic record/replay harness for the firmware
+ *
+ * \author Simeon Neykov
+ *
+ * The unmodified firmware sources are compiled for the host against the replacement headers in this directory,
+ * with HAL_HOST defined: the register accesses of serialGLCD/hal.h are the hal_*() functions of the simulated devices here.
+ * - Simulated time advances only on _delay_ms()/_delay_us() and by a fixed CPU quantum on every polled register,
+ *   thus the run does not depend on the host speed and is repeatable bit by bit
+ * - Port C levels (buttons and encoder phases) come from an input script, the same levels the TRACE_INPUT_EDGE
+ *   events record on the target (see tools/traceDecode -i)
+ * - Key matrix (see keypad.c): the script gives the keys held, a row driven low pulls the columns of its held keys
+ *   low. Rows are connected through the held keys as without diodes, thus three keys of a rectangle show the fourth.
+ * - Every byte written to UART0 is captured with its time stamp and fed to a model of the SparkFun backpack,
+ *   which keeps the character screen of the display geometry the firmware is built for (21x8, 26x16 with -DLCD160128)
+ * - The UART transmitter is modeled at 115200 baud, UDRE0 is set again one character time after the last write
+ * - HD44780 menu display (built with -DDISPLAY_16x2, -DDISPLAY_20x4, ...): a model of the controller on the 4-bit bus
+ *   (see hd44780.c) keeps the DDRAM, the address counter and the busy time of each instruction. The driver holds E
+ *   high for one _delay_us() per bus cycle, each such call is one E pulse. A write while the controller is busy is
+ *   counted as an overrun. The report adds the bus writes per event, the busy polls and the character screen.
+ * - Interrupts: Timer1 overflow when TCNT1 is read, Timer0 compare (1ms tick) on time, never nested
+ *
+ * Environment:
+ * - REPLAY_SCRIPT	input script (required), lines "<ms> <PINC hex> [<keys hex>]", "# comment" and optional "end <ms>".
+ *					The keys held are a bit per key code (row * KEYPAD_COLS + column), none if not given
+ * - REPLAY_BASELINE	report of a known good run, the run fails on any difference
+ * - REPLAY_REPORT	file to write the report to (e.g. to make a new baseline)
+ * - REPLAY_DUMP	if set, every captured byte is listed on stderr with its time stamp in us
+ *
+ * The report lists per input event the number of bytes it caused and the modeled time to the first and last byte,
+ * the totals and the final screen.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "avr/io.h"
+#include "util/delay.h"
+#include "serialGLCD.h"
+#include "charMenu.h"
+#include "hd44780.h"
+
+#if (KEYPAD_ENABLE == TRUE) && ((KEYPAD_ROWS != 4) || (KEYPAD_COLS != 4))
+#error "the key matrix model is 4 x 4"
+#endif
+
+#define SIM_BYTE_NS			86806UL		///< 10 bits at 115200 baud
+#define SIM_POLL_NS			250UL		///< CPU time spent per polled register read (4 cycles at 16MHz)
+#define SIM_TICK_NS			4000UL		///< Timer1 tick, clk/64
+#define SIM_SETTLE_MS		3000UL		///< run time after the last input event if the script has no "end"
+#define SIM_IDLE_PINC		0x1F		///< all buttons released, encoder at rest (pull-ups)
+#define SIM_MAX_EVENTS		256
+#define SIM_MAX_BYTES		65536UL
+#define SIM_REPORT_SIZE		65536
+
+#define SCREEN_COLS			GLCD_COLS			///< panel of the firmware's geometry descriptor
+#define SCREEN_ROWS			GLCD_ROWS
+#define SCREEN_MAXX			INITIAL_pixel_MAXX
+#define SCREEN_MAXY			INITIAL_pixel_MAXY
+
+volatile uint8_t UDR0, UCSR0A, UCSR0B, UCSR0C, UBRR0H, UBRR0L;
+volatile uint8_t PINB, PINC, PIND, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD;
+volatile uint8_t TCCR0A, TCCR0B, OCR0A, TIMSK0;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1, PCICR, PCMSK1, SREG;
+volatile uint16_t TCNT1;
+
+void TIMER1_OVF_vect(void);
+void TIMER0_COMPA_vect(void) __attribute__((weak));
+
+typedef struct SimEventStructure {
+	unsigned long long at;		/**< ns */
+	uint8_t pinc;
+	uint16_t keys;				/**< keys held, bit per key code */
+	unsigned long bytes;		/**< bytes sent until the next event */
+	unsigned long lcdWrites;	/**< HD44780 instructions and characters written until the next event */
+	unsigned long long first;	/**< ns of the first byte, 0 if none */
+	unsigned long long last;	/**< ns of the last byte */
+}SimEvent;
+
+static unsigned long long sim_now = 0;			///< simulated time in ns
+static unsigned long long sim_end = 0;
+static unsigned long long sim_uartFree = 0;		///< transmitter accepts the next byte at this time
+static unsigned long sim_overflows = 0;			///< Timer1 overflows delivered
+static unsigned long long sim_timer0Next = 0;	///< time of the next Timer0 compare interrupt, 0 not running
+static unsigned char sim_inInterrupt = 0;		///< no nested interrupts, as on the MCU
+static SimEvent sim_events[SIM_MAX_EVENTS];
+static unsigned int sim_eventCount = 0;
+static unsigned int sim_eventNext = 0;			///< next event to apply
+static unsigned long sim_bytes = 0;
+static unsigned long long sim_lastByte = 0;
+static volatile uint8_t sim_pinc = SIM_IDLE_PINC;
+static uint16_t sim_keys = 0;					///< key matrix, keys held
+static unsigned char sim_keypad = 0;			///< the script uses the key matrix, the report lists the keys
+static unsigned char sim_dump = 0;				///< REPLAY_DUMP set, every byte is listed on stderr
+
+static char screen[SCREEN_ROWS][SCREEN_COLS + 1];
+static unsigned char screen_x, screen_y, screen_backlight = 100, screen_reverse;
+static unsigned long screen_graphics;			///< box, line, pixel and erase commands
+static unsigned char backpack_cmd = 0;			///< command in progress
+static unsigned char backpack_args = 0;			///< argument bytes still expected
+static unsigned char backpack_arg[6];
+static unsigned char backpack_argIndex;
+
+typedef struct SimPinStructure {
+	volatile uint8_t *port;
+	volatile uint8_t *ddr;
+	uint8_t pin;
+}SimPin;
+
+#define SIM_PIN_(port, pin)		{ &PORT##port, &DDR##port, pin }
+#define SIM_PIN(...)			SIM_PIN_(__VA_ARGS__)		///< SimPin of a pin descriptor of main.h
+#define SIM_LEVEL(simPin)		((*(simPin).port >> (simPin).pin) & 1)	///< port bit of a SimPin
+
+static void sim_finish(void);
+
+/** ##Backpack model - blank character screen
+ */
+static void screen_clear(void)
+{
+	unsigned char row;
+
+	for (row = 0; row < SCREEN_ROWS; row++)
+	{
+		memset(screen[row], ' ', SCREEN_COLS);
+		screen[row][SCREEN_COLS] = 0;
+	}
+}
+
+/** ##Backpack model - executes one complete command
+ */
+static void backpack_execute(void)
+{
+	switch (backpack_cmd)
+	{
+		case 0x00:
+			screen_clear();
+			screen_x = 0;
+			screen_y = 0;
+			break;
+		case 0x02: screen_backlight = backpack_arg[0]; break;
+		case 0x12: screen_reverse ^= 1; break;
+		case 0x18: screen_x = backpack_arg[0]; break;
+		case 0x19: screen_y = backpack_arg[0]; break;
+		default: screen_graphics++; break;
+	}
+}
+
+/** ##Backpack model - one received byte
+ *
+ * 0x7C starts a command, the number of argument bytes depends on the command.
+ * Other bytes are characters drawn at the pixel position, 6x8 font, wrapping at the screen edge.
+ *
+ */
+static void backpack_feed(unsigned char data)
+{
+	if (backpack_args)
+	{
+		backpack_arg[backpack_argIndex++] = data;
+		if (--backpack_args == 0) backpack_execute();
+		return;
+	}
+	if (backpack_cmd == 0x7C)
+	{
+		static const unsigned char args[0x20] = {
+			[0x02] = 1, [0x05] = 4, [0x0C] = 5, [0x0F] = 5, [0x10] = 3, [0x18] = 1, [0x19] = 1 };
+		backpack_cmd = data;
+		backpack_argIndex = 0;
+		backpack_args = data < sizeof(args) ? args[data] : 0;
+		if (backpack_args == 0) backpack_execute();
+		if (backpack_args == 0) backpack_cmd = 0;
+		return;
+	}
+	if (data == 0x7C)
+	{
+		backpack_cmd = 0x7C;
+		return;
+	}
+	backpack_cmd = 0;
+	if (screen_y / GLCD_CHAR_HEIGHT < SCREEN_ROWS && screen_x / GLCD_CHAR_WIDTH < SCREEN_COLS)
+	{
+		screen[screen_y / GLCD_CHAR_HEIGHT][screen_x / GLCD_CHAR_WIDTH] = (data >= 0x20 && data < 0x7F) ? data : '?';
+	}
+	screen_x += GLCD_CHAR_WIDTH;
+	if (screen_x + GLCD_CHAR_WIDTH - 1 > SCREEN_MAXX)
+	{
+		screen_x = 0;
+		screen_y += GLCD_CHAR_HEIGHT;
+		if (screen_y + GLCD_CHAR_HEIGHT - 1 > SCREEN_MAXY) screen_y = 0;
+	}
+}
+
+#ifndef DISPLAY_GLCD
+#define LCD_COLS			INITIAL_MAXX		///< HD44780 panel of the firmware's display type
+#define LCD_ROWS			DISPLAY_ROWS
+#define LCD_CLEAR_NS		1520000ULL			///< clear display and return home
+#define LCD_EXEC_NS			37000ULL			///< other instructions and character writes
+
+static const SimPin lcd_rs = SIM_PIN(PIN_LCD_RS);
+static const SimPin lcd_rw = SIM_PIN(PIN_LCD_RW);
+static const SimPin lcd_e = SIM_PIN(PIN_LCD_E);
+static unsigned char lcd_ddram[128];
+static unsigned char lcd_address = 0;			///< address counter, DDRAM
+static unsigned char lcd_4bit = 0;				///< 4-bit interface set, two E pulses per byte
+static unsigned char lcd_low = 0;				///< next pulse of a byte is its lower nibble
+static unsigned char lcd_high;					///< upper nibble written
+static unsigned char lcd_out = 0;				///< nibble driven on D4..D7 by the last read pulse
+static unsigned char lcd_on = 0;				///< display on
+static unsigned long long lcd_busyUntil = 0;	///< busy flag is set until this time
+static unsigned long lcd_writes = 0;
+static unsigned long lcd_polls = 0;				///< status reads with the busy flag set
+static unsigned long lcd_overruns = 0;			///< writes while the controller was busy
+
+/** ##HD44780 model - one instruction or character
+ */
+static void lcd_execute(unsigned char data, unsigned char rs)
+{
+	unsigned long long busy = LCD_EXEC_NS;
+
+	if (sim_now < lcd_busyUntil) lcd_overruns++;
+	lcd_writes++;
+	if (sim_eventNext) sim_events[sim_eventNext - 1].lcdWrites++;
+	if (rs)
+	{
+		lcd_ddram[lcd_address] = data;
+		lcd_address++;
+		if (lcd_address == 0x28) lcd_address = 0x40;		// 2-line addressing, the lines are 40 characters long
+		else if (lcd_address == 0x68) lcd_address = 0x00;
+	}
+	else if (data & 0x80) lcd_address = data & 0x7F;
+	else if (data & 0x40) ;									// CGRAM address, not used
+	else if (data & 0x20) lcd_4bit = !(data & 0x10);		// function set, DL
+	else if (data & 0x10) ;									// cursor or display shift, not used
+	else if (data & 0x08) lcd_on = (data & 0x04) != 0;
+	else if (data & 0x04) ;									// entry mode, increment is assumed
+	else if (data)
+	{
+		if (data == 0x01) memset(lcd_ddram, ' ', sizeof(lcd_ddram));
+		lcd_address = 0;
+		busy = LCD_CLEAR_NS;
+	}
+	lcd_busyUntil = sim_now + busy;
+}
+
+/** ##HD44780 model - E pulse, a write latches D4..D7, a read drives the busy flag and the address counter on them
+ */
+static void lcd_pulse(void)
+{
+	unsigned char status;
+	unsigned char nibble = (lcdData_dataPort >> lcdData_shift) & 0x0F;
+
+	if (SIM_LEVEL(lcd_rw))
+	{
+		status = ((sim_now < lcd_busyUntil) ? HD44780_BUSY_FLAG : 0) | lcd_address;
+		if (!lcd_low && (status & HD44780_BUSY_FLAG)) lcd_polls++;
+		lcd_out = lcd_low ? status & 0x0F : status >> 4;
+		lcd_low = !lcd_low;
+	}
+	else if (!lcd_4bit) lcd_execute(nibble << 4, SIM_LEVEL(lcd_rs));	// 8-bit interface, D0..D3 not connected
+	else if (!lcd_low)
+	{
+		lcd_high = nibble;
+		lcd_low = 1;
+	}
+	else
+	{
+		lcd_low = 0;
+		lcd_execute((lcd_high << 4) | nibble, SIM_LEVEL(lcd_rs));
+	}
+}
+#endif
+
+/** ##UART model - takes the byte written to the transmit buffer
+ */
+static void sim_capture(unsigned char data)
+{
+	SimEvent *event;
+
+	if (sim_dump) fprintf(stderr, "%10llu %02X\n", sim_now / 1000, data);
+	backpack_feed(data);
+	if (sim_bytes++ >= SIM_MAX_BYTES)
+	{
+		fprintf(stderr, "replay: output limit reached\n");
+		exit(2);
+	}
+	sim_lastByte = sim_now;
+	sim_uartFree = sim_now + SIM_BYTE_NS;
+	if (sim_eventNext)
+	{
+		event = &sim_events[sim_eventNext - 1];
+		if (!event->bytes) event->first = sim_now;
+		event->bytes++;
+		event->last = sim_now + SIM_BYTE_NS;
+	}
+}
+
+/** ##Simulated time - input events that became due
+ */
+static void sim_inputs(void)
+{
+	while (sim_eventNext < sim_eventCount && sim_events[sim_eventNext].at <= sim_now)
+	{
+		sim_pinc = sim_events[sim_eventNext].pinc;
+		sim_keys = sim_events[sim_eventNext].keys;
+		sim_eventNext++;
+	}
+}
+
+/** ##Simulated time - advance, deliver the Timer0 interrupts and apply the input events on the way
+ */
+static void sim_advance(unsigned long long ns)
+{
+	unsigned long long target;
+	unsigned long long period = (OCR0A + 1ULL) * SIM_TICK_NS;
+
+	target = sim_now + ns;
+	if (!(TIMSK0 & (1 << OCIE0A)) || !TIMER0_COMPA_vect) sim_timer0Next = 0;
+	else if (!sim_timer0Next) sim_timer0Next = sim_now + period;
+	while (sim_timer0Next && (sim_timer0Next <= target) && !sim_inInterrupt)
+	{
+		if (sim_now < sim_timer0Next) sim_now = sim_timer0Next;
+		sim_inputs();
+		sim_inInterrupt = 1;
+		TIMER0_COMPA_vect();
+		sim_inInterrupt = 0;
+		sim_timer0Next += period;
+	}
+	if (sim_now < target) sim_now = target;
+	sim_inputs();
+	if (sim_now >= sim_end) sim_finish();
+}
+
+/** ##HAL - UART0 transmitter ready, UDRE0 is set one character time after the last byte
+ */
+unsigned char hal_uart0Ready(void)
+{
+	sim_advance(SIM_POLL_NS);
+	return sim_now >= sim_uartFree;
+}
+
+/** ##HAL - UART0 transmit buffer loaded
+ */
+void hal_uart0Write(unsigned char data)
+{
+	sim_capture(data);
+}
+
+/** ##HAL - port C levels of the replayed input script at the current simulated time
+ */
+unsigned char hal_pinC(void)
+{
+	sim_advance(SIM_POLL_NS);
+	return sim_pinc;
+}
+
+#if (KEYPAD_ENABLE == TRUE)
+static const SimPin sim_rows[KEYPAD_ROWS] = { SIM_PIN(PIN_KEYPAD_ROW0), SIM_PIN(PIN_KEYPAD_ROW1), SIM_PIN(PIN_KEYPAD_ROW2), SIM_PIN(PIN_KEYPAD_ROW3) };
+static const SimPin sim_cols[KEYPAD_COLS] = { SIM_PIN(PIN_KEYPAD_COL0), SIM_PIN(PIN_KEYPAD_COL1), SIM_PIN(PIN_KEYPAD_COL2), SIM_PIN(PIN_KEYPAD_COL3) };
+
+/** ##Key matrix model - bits of a port pulled low by the matrix
+ *
+ * The rows driven low (output, port bit low) pull the columns of their held keys low, such a column pulls the
+ * other rows of its held keys low, and so on until nothing changes.
+ */
+static uint8_t sim_matrixLow(volatile uint8_t *port)
+{
+	unsigned char lowRows = 0;
+	unsigned char lowCols = 0;
+	unsigned char changed = 1;
+	unsigned char row, col;
+	uint8_t bits = 0;
+
+	for (row = 0; row < KEYPAD_ROWS; row++)
+	{
+		const SimPin *pin = &sim_rows[row];
+		if ((*pin->ddr & (1 << pin->pin)) && !(*pin->port & (1 << pin->pin))) lowRows |= 1 << row;
+	}
+	while (changed)
+	{
+		changed = 0;
+		for (row = 0; row < KEYPAD_ROWS; row++)
+		{
+			for (col = 0; col < KEYPAD_COLS; col++)
+			{
+				if (!(sim_keys & (1 << (row * KEYPAD_COLS + col)))) continue;
+				if ((lowRows & (1 << row)) && !(lowCols & (1 << col))) { lowCols |= 1 << col; changed = 1; }
+				if ((lowCols & (1 << col)) && !(lowRows & (1 << row))) { lowRows |= 1 << row; changed = 1; }
+			}
+		}
+	}
+	for (col = 0; col < KEYPAD_COLS; col++)
+	{
+		if ((lowCols & (1 << col)) && (sim_cols[col].port == port)) bits |= 1 << sim_cols[col].pin;
+	}
+	for (row = 0; row < KEYPAD_ROWS; row++)
+	{
+		if ((lowRows & (1 << row)) && (sim_rows[row].port == port)) bits |= 1 << sim_rows[row].pin;
+	}
+	return bits;
+}
+#else
+#define sim_matrixLow(port)		0
+#endif
+
+/** ##HAL - port B levels: outputs and pull-ups, the key matrix pulls some low
+ */
+unsigned char hal_pinB(void)
+{
+	sim_advance(SIM_POLL_NS);
+	return (PINB | PORTB) & ~sim_matrixLow(&PORTB);
+}
+
+/** ##HAL - port D levels: outputs and pull-ups, the key matrix pulls some low
+ */
+unsigned char hal_pinD(void)
+{
+	unsigned char level;
+
+	sim_advance(SIM_POLL_NS);
+	level = (PIND | PORTD) & ~sim_matrixLow(&PORTD);
+#ifndef DISPLAY_GLCD
+	// status read of the HD44780, it drives D4..D7 while E is high
+	if (SIM_LEVEL(lcd_rw) && SIM_LEVEL(lcd_e)) level = (level & ~(0x0F << lcdData_shift)) | (lcd_out << lcdData_shift);
+#endif
+	return level;
+}
+
+/** ##HAL - simulated Timer1 count, the overflow interrupts missed meanwhile are delivered first
+ */
+unsigned int hal_timer1Count(void)
+{
+	unsigned long long ticks;
+
+	sim_advance(SIM_POLL_NS);
+	ticks = sim_now / SIM_TICK_NS;
+	while (sim_overflows < (ticks >> 16))
+	{
+		sim_overflows++;
+		sim_inInterrupt++;
+		TIMER1_OVF_vect();
+		sim_inInterrupt--;
+	}
+	return (uint16_t)ticks;
+}
+
+/** ##HAL - Timer1 overflow flag, never pending: the overflows are always delivered already
+ */
+unsigned char hal_timer1Overflow(void)
+{
+	return 0;
+}
+
+void _delay_ms(double ms)
+{
+	sim_advance((unsigned long long)(ms * 1000000.0));
+}
+
+void _delay_us(double us)
+{
+#ifndef DISPLAY_GLCD
+	if (SIM_LEVEL(lcd_e)) lcd_pulse();
+#endif
+	sim_advance((unsigned long long)(us * 1000.0));
+}
+
+/* memory.c relies on the AVR linker symbols and .init1, the stack watermark is not simulated */
+unsigned int memory_static(void) { return 0; }
+unsigned int memory_stackHighWater(void) { return 0; }
+unsigned int memory_stackUnused(void) { return 0; }
+unsigned int memory_free(void) { return 0; }
+
+/** ##Report - the result of the run as text, exactly comparable to a baseline
+ */
+static size_t sim_report(char *out, size_t size)
+{
+	size_t len = 0;
+	unsigned int i;
+
+#define REPORT(...) len += snprintf(out + len, len < size ? size - len : 0, __VA_ARGS__)
+	for (i = 0; i < sim_eventCount; i++)
+	{
+		SimEvent *event = &sim_events[i];
+		REPORT("event %8llu us pinc %02X", event->at / 1000, event->pinc);
+		if (sim_keypad) REPORT(" keys %04X", event->keys);
+		REPORT(" bytes %5lu", event->bytes);
+#ifndef DISPLAY_GLCD
+		REPORT(" lcd %4lu", event->lcdWrites);
+#endif
+		if (event->bytes)
+		{
+			REPORT(" first %7llu us done %7llu us", (event->first - event->at) / 1000, (event->last - event->at) / 1000);
+		}
+		REPORT("\n");
+	}
+	REPORT("uart_bytes %lu\n", sim_bytes);
+	REPORT("uart_wire_us %llu\n", (unsigned long long)sim_bytes * SIM_BYTE_NS / 1000);
+	REPORT("last_byte_us %llu\n", sim_lastByte / 1000);
+	REPORT("graphics_commands %lu\n", screen_graphics);
+	REPORT("backlight %u reverse %u\n", screen_backlight, screen_reverse);
+	for (i = 0; i < SCREEN_ROWS; i++) REPORT("|%s|\n", screen[i]);
+#ifndef DISPLAY_GLCD
+	REPORT("hd44780_writes %lu busy_polls %lu overruns %lu display %s\n", lcd_writes, lcd_polls, lcd_overruns, lcd_on ? "on" : "off");
+	for (i = 0; i < LCD_ROWS; i++)
+	{
+		// rows 3 and 4 continue rows 1 and 2 in DDRAM
+		const unsigned char *row = &lcd_ddram[((i & 1) ? 0x40 : 0x00) + ((i & 2) ? LCD_COLS : 0)];
+		REPORT("[%.*s]\n", LCD_COLS, row);
+	}
+#endif
+#undef REPORT
+	return len < size ? len : size - 1;
+}
+
+/** ##End of the run - report, compare to the baseline and leave the firmware's endless loop
+ */
+static void sim_finish(void)
+{
+	static char report[SIM_REPORT_SIZE];
+	static char baseline[SIM_REPORT_SIZE];
+	const char *baselineFile = getenv("REPLAY_BASELINE");
+	const char *reportFile = getenv("REPLAY_REPORT");
+	size_t len;
+	size_t baselineLen;
+	size_t i;
+	unsigned int line = 1;
+	FILE *file;
+
+	len = sim_report(report, sizeof(report));
+	fputs(report, stdout);
+	if (reportFile)
+	{
+		file = fopen(reportFile, "w");
+		if (!file || fwrite(report, 1, len, file) != len)
+		{
+			fprintf(stderr, "replay: cannot write %s\n", reportFile);
+			exit(2);
+		}
+		fclose(file);
+	}
+	if (baselineFile)
+	{
+		file = fopen(baselineFile, "r");
+		if (!file)
+		{
+			fprintf(stderr, "replay: cannot read %s\n", baselineFile);
+			exit(2);
+		}
+		baselineLen = fread(baseline, 1, sizeof(baseline) - 1, file);
+		fclose(file);
+		for (i = 0; i < len && i < baselineLen && report[i] == baseline[i]; i++)
+		{
+			if (report[i] == '\n') line++;
+		}
+		if (i != len || i != baselineLen)
+		{
+			fprintf(stderr, "replay: differs from %s at line %u\n", baselineFile, line);
+			exit(1);
+		}
+		fprintf(stderr, "replay: matches %s\n", baselineFile);
+	}
+	exit(0);
+}
+
+/** ##Input script - loaded before the firmware's main() starts
+ */
+__attribute__((constructor))
+static void sim_load(void)
+{
+	const char *scriptFile = getenv("REPLAY_SCRIPT");
+	char line[128];
+	unsigned long ms;
+	unsigned int pinc;
+	unsigned int keys;
+	int fields;
+	unsigned long long end = 0;
+	FILE *file;
+
+	screen_clear();
+#ifndef DISPLAY_GLCD
+	memset(lcd_ddram, ' ', sizeof(lcd_ddram));
+#endif
+	sim_dump = getenv("REPLAY_DUMP") != 0;
+	if (!scriptFile || !(file = fopen(scriptFile, "r")))
+	{
+		fprintf(stderr, "replay: set REPLAY_SCRIPT to an input script\n");
+		exit(2);
+	}
+	while (fgets(line, sizeof(line), file))
+	{
+		if (sscanf(line, "end %lu", &ms) == 1)
+		{
+			end = ms * 1000000ULL;
+		}
+		else if ((fields = sscanf(line, "%lu %x %x", &ms, &pinc, &keys)) >= 2)
+		{
+			if (sim_eventCount == SIM_MAX_EVENTS)
+			{
+				fprintf(stderr, "replay: too many events in %s\n", scriptFile);
+				exit(2);
+			}
+			sim_events[sim_eventCount].at = ms * 1000000ULL;
+			sim_events[sim_eventCount].pinc = (uint8_t)pinc;
+			sim_events[sim_eventCount].keys = (fields == 3) ? (uint16_t)keys : 0;
+			if (fields == 3) sim_keypad = 1;
+			sim_eventCount++;
+		}
+	}
+	fclose(file);
+	sim_end = end ? end : (sim_eventCount ? sim_events[sim_eventCount - 1].at : 0) + SIM_SETTLE_MS * 1000000ULL;
+}
@@ -0,0 +1,15 @@
+/*
+ * util/delay.h - host build replacement
+ *
+ * \author Simeon Neykov
+ *
+ * Delays advance the simulated time instead of burning cycles.
+ */
+
+#ifndef HOST_UTIL_DELAY_H_
+#define HOST_UTIL_DELAY_H_
+
+void _delay_ms(double ms);
+void _delay_us(double us);
+
+#endif /* HOST_UTIL_DELAY_H_ */
@@ -1,239 +1,855 @@
-﻿/** \page pageMenu Menu Handler
- * 
- * ##Utilize re-usable menu structure
- *
- * charMenu.c
- *
- * \author	Simeon Neykov.
- *
- * [Reference](https://www.youtube.com/watch?v=PFzNBtnfJ6Y&list=PLfGDzGG5F5eYNBkXs0tTdXqLB3KE5CFgx)
- *
- */
-
-#include <math.h>
-//#include <stdint.h>              // needed for uint8_t types, etc
-//#include <stdbool.h>             // needed for boolean types, etc
-#include <stdio.h>
-//#include <stdlib.h>
-#include <string.h>
-#include <avr/io.h>
-#include "main.h"
-#include "USART.h"
-#include "serialGLCD.h"
-#include "charMenu.h" 
-#include <util/delay.h>
-
-unsigned char selected = 1;			///< selected is used for indexing the elements from MenuEntry defined structure
-
-const char menu_000[] = "-<Main Menu>-------";	// 0
-const char menu_001[] = "Option1";					// 1
-const char menu_002[] = "Go to SubMenu";			// 2
-const char menu_003[] = "Option3";					// 3
-const char menu_004[] = "Option4";					// 4
-const char menu_005[] = "Option5";					// 5
-const char menu_006[] = "Option6";					// 6
-const char menu_007[] = "NextOption7";				// 7
-const char menu_008[] = "Option8";					// 8
-const char menu_009[] = "START";					// 9
-
-const char menu_010[] = "-<Sub Menu>--------";	// 10
-const char menu_011[] = "SubOption1";				// 11
-const char menu_012[] = "Rotary Counter";	// 12
-const char menu_013[] = "SubOption3";				// 13
-const char menu_014[] = "SubOption4";				// 14
-const char menu_015[] = "SubOption5";				// 15
-const char menu_016[] = "RETURN";					// 16
-
-MenuEntry my_menu[] =
-{
-    {menu_000, 10, 0, 0, 0,  0},					// selected = 0
-    {menu_001, 10, 1, 2, 1,  0},					// selected = 1
-    {menu_002, 10, 1, 3, 11, 0},					// selected = 2
-    {menu_003, 10, 2, 4, 3,  0},					// selected = 3
-    {menu_004, 10, 3, 5, 4,  0},					// selected = 4
-    {menu_005, 10, 4, 6, 5,  0},					// selected = 5
-    {menu_006, 10, 5, 7, 6,  0},					// selected = 6
-    {menu_007, 10, 6, 8, 7,  0},					// selected = 7
-    {menu_008, 10, 7, 9, 8,  0},					// selected = 8
-    {menu_009, 10, 8, 9, 9,  start},				// selected = 9. Call function start if "enter" event
-    
-    {menu_010, 7, 0,  0,  0,  0},					// selected = 10
-    {menu_011, 7, 7,  12, 11, 0},					// selected = 11
-    {menu_012, 7, 11, 13, 12, rotary_counter},					// selected = 12
-    {menu_013, 7, 12, 14, 13, 0},					// selected = 13
-    {menu_014, 7, 13, 15, 14, 0},					// selected = 14
-    {menu_015, 7, 14, 16, 15, 0},					// selected = 15
-    {menu_016, 7, 15, 16, 1,  0},					// selected = 16		
-};
-
-/** ##Menu Handler - send LCD menu string at reference location
- * 
- * Set refX and refY to the character LCD format (e.g. 21x8) indexed from 0, 0
- *
- * Consider UART was initialized and enabled.
- * @param refX, refY reference coordinates as for character LCD format (e.g. 21 x 8) indexed from 0, 0.
- * @param *lcd_menu_items a pointer to the characters in selected menu item to be displayed on the LCD screen
- * @param add_line if 1 (or just > 1) then complete the row with character given in add_char. If add_line =0 the row would not be completed till the end.
- * @param add_char character to be used to complete the row after the menu string if add_line >=1.
- *
- */
-void serialGLCD_writeMenuString (unsigned char refX, unsigned char refY, const char *lcd_menu_items, unsigned char add_line, char add_char) 
-{
-	unsigned char lcd_i;
-	unsigned char lcd_offset = 0;
-	// find pixel X
-	unsigned char pixelX = (refX) * 6;
-	// find pixel Y
-	unsigned char pixelY = (refY) * 8;
-	// check the range
-	if (pixelX > INITIAL_pixel_MAXX) pixelX = 0;
-	if (pixelY > INITIAL_pixel_MAXY) pixelY = 0;
-	
-	serialGLCD_gotoPixel_XY(pixelX, pixelY);
-	
-	lcd_offset = strlen(lcd_menu_items);
-	
-	if (lcd_offset > INITIAL_MAXX) lcd_offset = INITIAL_MAXX;
-	for (lcd_i = lcd_offset; lcd_i; lcd_i--)
-	{
-		serialGLCD_sendChar(*lcd_menu_items++);
-	}
-	if (add_line)
-	{
-		for (lcd_i = INITIAL_MAXX - lcd_offset - refX; lcd_i; lcd_i--) 
-		{
-			serialGLCD_sendChar(add_char);
-		}
-	}
-}
-
-/** ##Menu Handler - show LCD menu on the screen
- *
- * Consider UART was initialized and enabled.
- *
- * Chosen menu item is contained in global variable 'selected'
- *
- * Structure of menu handler
- * - Input base: 
- *   - how many rows has the display, this is defined in 'DISPLAY_ROWS' macro definition
- *   - how many rows on the screen has the menu itself (or sub-menu, etc), stored in 'MenuEntry' structure, field 'num_menupoints' 
- *   - the range within which the selector could be displayed without need to scroll the display
- *     - 'UPPER_SPACE' and 'LOWER_SPACE'MACROs predefined 
- *   - in case 'num_menupoints' is less than DISPLAY_ROWS, to ensure unwanted screen scrolling:
- *     - actual number of rows to be displayed is 'num_menupoints' 
- *     - 'UPPER_SPACE' is recalculated to keep 2 rows less than the number of rows to be displayed
- *     - ensure to clear the display when short menu is entered, thus to delete remains from previous menu (the use of 'enClear' flag)
- *
- * - Menu handler model: could be represented like the display is a "frame-mask" moved over the indexed menu items list
- *     - thus have to be defined: 'from' which menu item 'till' which menu item depends of the menu selector 'selected'
- *         - this should be done within the range of items from the same menu/sub-menu, means the same 'num_menupoints'
- *     - ensure correct range depends of the usage of 'VISIBLE_MENU_HEADER' and upper and lower spaces
- *     - show the menu items listed in between 'from' and 'till', show selection marks and control scrolling depending of the valid range
- * 
- */
-void show_menu(void)
-{
-	unsigned char line_cnt = 0;
-	unsigned char from = 0;		// from which row of menu points
-	unsigned char till = 0;		// till which row of menu points
-	unsigned char temp = 0;
-	unsigned char varDisplay_rows = DISPLAY_ROWS;
-	unsigned char varUpper_space = UPPER_SPACE;
-	static unsigned char enClear = 1;
-	char buffer[21];
-	
-	// define from and till spec for the menu
-	if (my_menu[selected].num_menupoints < DISPLAY_ROWS) 
-	{
-		varDisplay_rows = my_menu[selected].num_menupoints;
-		varUpper_space = varDisplay_rows - 2;
-		if (enClear)
-		{
-			serialGLCD_clear();
-			enClear = 0;
-		}
-	} else {
-		enClear = 1;
-	}
-	while (till <= selected)
-	{
-		till += my_menu[till].num_menupoints;
-	}
-	from = till - my_menu[selected].num_menupoints;
-	temp = from;
-	till--;
-	
-	if ((selected >= (from +varUpper_space)) && (selected <= (till - LOWER_SPACE))) 
-	{
-		from = selected - varUpper_space;
-		till = from + (varDisplay_rows - 1);
-		if (VISIBLE_MENU_HEADER) 
-		{
-			serialGLCD_writeMenuString(0, 0, my_menu[temp].text, 1, ' ');
-			line_cnt = 1;
-			from ++;
-		}
-		for (from; from <= till; from++) 
-		{
-			if (from == selected) 
-			{
-				sprintf(buffer, ">%s", my_menu[from].text);
-				serialGLCD_writeMenuString(0, line_cnt, buffer, 1, SELECTION_CHAR_END);
-				line_cnt++;	
-			} else {
-				sprintf(buffer, " %s", my_menu[from].text);
-				serialGLCD_writeMenuString(0, line_cnt, buffer, 1, ' ');
-				line_cnt++;
-			}
-		}
-	} else {
-		if (selected < (from +varUpper_space)) 
-		{
-			till = from + (varDisplay_rows - 1);
-			for (from; from <= till; from++) 
-			{
-				if (from == selected) 
-				{
-					sprintf(buffer, ">%s", my_menu[from].text);
-					serialGLCD_writeMenuString(0, line_cnt, buffer, 1, SELECTION_CHAR_END);
-					line_cnt++;					
-				} else {
-					if ((VISIBLE_MENU_HEADER) && (line_cnt == 0))
-					{
-					// if this is the header line - don't add ' ' at the beginning	
-						serialGLCD_writeMenuString(0, line_cnt, my_menu[from].text, 1, ' ');
-						line_cnt++;
-					} else {
-						sprintf(buffer, " %s", my_menu[from].text);
-						serialGLCD_writeMenuString(0, line_cnt, buffer, 1, ' ');
-						line_cnt++;
-					}
-				}
-			}
-		} else {
-			if (selected == till)
-			{
-				from = till - (varDisplay_rows - 1);
-				if (VISIBLE_MENU_HEADER) 
-				{
-					serialGLCD_writeMenuString(0, 0, my_menu[temp].text, 1, ' '); 
-					line_cnt = 1; 
-					from ++;
-				}
-				for (from; from <= till; from++) 
-				{
-					if (from == selected) 
-					{
-						sprintf(buffer, ">%s", my_menu[from].text);
-						serialGLCD_writeMenuString(0, line_cnt, buffer, 1, SELECTION_CHAR_END);
-						line_cnt++;				
-					} else {
-						sprintf(buffer, " %s", my_menu[from].text);
-						serialGLCD_writeMenuString(0, line_cnt, buffer, 1, ' ');
-						line_cnt++;
-					}
-				}
-			}
-		}
-	}
-}
\ No newline at end of file
+﻿/** \page pageMenu Menu Handler
+ * 
+ * ##Utilize re-usable menu structure
+ *
+ * charMenu.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * [Reference](https://www.youtube.com/watch?v=PFzNBtnfJ6Y&list=PLfGDzGG5F5eYNBkXs0tTdXqLB3KE5CFgx)
+ *
+ */
+
+#include <math.h>
+//#include <stdint.h>              // needed for uint8_t types, etc
+//#include <stdbool.h>             // needed for boolean types, etc
+#include <stdio.h>
+//#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <avr/io.h>
+#include "main.h"
+#include "USART.h"
+#include "serialGLCD.h"
+#include "charMenu.h" 
+#include "charMenuIndex.h"
+#include "hd44780.h"
+#include "timer.h"
+#include "trace.h"
+#include <util/delay.h>
+
+unsigned char selected = 1;			///< selected is used for indexing the elements from MenuEntry defined structure
+
+static void serialGLCD_mirrorClear(void);
+static void serialGLCD_mirrorWriteMenuString(unsigned char refX, unsigned char refY, const char *lcd_menu_items, unsigned char add_line, char add_char);
+
+MenuDisplay serialGLCD_menuDisplay = { serialGLCD_clear, serialGLCD_writeMenuString, serialGLCD_flush, serialGLCD_busy };	///< serial GLCD backend of the menu handler, active display only
+MenuDisplay serialGLCD_mirrorMenuDisplay = { serialGLCD_mirrorClear, serialGLCD_mirrorWriteMenuString, serialGLCD_flush, serialGLCD_busy };	///< serial GLCD backend of the menu handler, all registered displays
+
+unsigned char menu_speculation = TRUE;		///< speculative pre-render of the likely next states during idle time, see menu_speculate()
+static MenuFrame menu_specCache[MENU_SPECULATION_SLOTS];	///< frames prepared for up, down, enter of 'menu_specBase'
+static unsigned char menu_specBase = MENU_NO_ITEM;			///< selected item the speculation cache is prepared for
+static unsigned char menu_specNext = 0;						///< next candidate to be prepared (0 up, 1 down, 2 enter)
+
+unsigned int menu_latencyLast = 0;			///< latency instrumentation: last event to first byte time in us
+unsigned long menu_latencySum[2];			///< latency instrumentation: sum of latencies in us, [0] speculation off, [1] on
+unsigned int menu_latencyCount[2];			///< latency instrumentation: number of measured events, [0] speculation off, [1] on
+static unsigned char menu_latencyArmed = 0;
+static unsigned char menu_latencyMode = 0;
+static unsigned long menu_latencyStartTick = 0;
+
+unsigned int menu_listIndex = 0;				///< selected item of the virtual list shown, see MenuList
+
+static const unsigned char menu_groupStart[] = MENU_GROUP_STARTS;	///< first-letter groups of the static menu, generated by tools/menuIndex
+static unsigned char menu_gridHeader = MENU_NO_ITEM;	///< grid section on the screen, MENU_NO_ITEM if none (or the screen is not known)
+static unsigned char menu_gridFirst = MENU_NO_ITEM;		///< first item of its first shown row
+static unsigned char menu_gridSelected = MENU_NO_ITEM;	///< item marked as selected on the screen
+
+static MenuList *menu_jumpList = 0;						///< virtual list the jump index is built for
+static unsigned int menu_jumpCount = 0;					///< its number of items when the index was built
+static unsigned char menu_jumpGroups = 0;				///< number of groups indexed
+static unsigned int menu_jumpStart[MENU_JUMP_GROUPS];	///< first item of each group
+
+static unsigned char menu_marqueeRow = MENU_NO_ITEM;	///< display row of the scrolling label, MENU_NO_ITEM if none
+static unsigned char menu_marqueeOffset = 0;			///< first label character shown
+static unsigned long menu_marqueeNext = 0;				///< time of the next scroll step in ms
+
+static void menu_frame(unsigned char sel, MenuFrame *frame);
+static void menu_formatRow(MenuFrame *frame, unsigned char line, char *buffer);
+static unsigned char menu_rowSelected(MenuFrame *frame, unsigned char line);
+
+#ifdef DISPLAY_GLCD
+MenuDisplay *menu_display = &serialGLCD_menuDisplay;	///< display backend used by show_menu(), selected by the display type
+#else
+MenuDisplay *menu_display = &hd44780_menuDisplay;		///< display backend used by show_menu(), selected by the display type
+#endif
+
+const char menu_000[] = "-<Main Menu>-------";	// 0
+const char menu_001[] = "Option1";					// 1
+const char menu_002[] = "Go to SubMenu";			// 2
+const char menu_003[] = "Device name";				// 3
+const char menu_004[] = "Backlight";				// 4
+const char menu_005[] = "Option5 has a label longer than the row";	// 5
+const char menu_006[] = "About";					// 6
+const char menu_007[] = "Plot demo";				// 7
+const char menu_008[] = "Presets";					// 8
+const char menu_009[] = "START";					// 9
+
+const char menu_010[] = "-<Sub Menu>--------";	// 10
+const char menu_011[] = "SubOption1";				// 11
+const char menu_012[] = "Rotary Counter";	// 12
+const char menu_013[] = "Latency stats";			// 13
+const char menu_014[] = "Memory stats";			// 14
+const char menu_015[] = "Device list";				// 15
+const char menu_016[] = "RETURN";					// 16
+
+const char menu_017[] = "-<Devices>---------";	// 17
+
+const char menu_018[] = "-<Presets>---------";	// 18
+const char menu_019[] = "Idle";					// 19
+const char menu_020[] = "Slow";					// 20
+const char menu_021[] = "Normal";					// 21
+const char menu_022[] = "Fast";					// 22
+const char menu_023[] = "Turbo";					// 23
+const char menu_024[] = "Eco";						// 24
+const char menu_025[] = "Night";					// 25
+const char menu_026[] = "Day";						// 26
+const char menu_027[] = "Auto";					// 27
+
+MenuEntry my_menu[] =
+{
+    {menu_000, 10, 0, 0, 0,  0},					// selected = 0
+    {menu_001, 10, 1, 2, 1,  0},					// selected = 1
+    {menu_002, 10, 1, 3, 11, 0},					// selected = 2
+    {menu_003, 10, 2, 4, 3,  MENU_GLCD(name_edit)},	// selected = 3
+    {menu_004, 10, 3, 5, 4,  param_edit, &backlight_param},	// selected = 4. Generic handler, the parameter is the context
+    {menu_005, 10, 4, 6, 5,  0},					// selected = 5
+    {menu_006, 10, 5, 7, 6,  MENU_GLCD(about_text)},	// selected = 6
+    {menu_007, 10, 6, 8, 7,  MENU_GLCD(plot_demo)},	// selected = 7
+    {menu_008, 10, 7, 9, 19, 0},					// selected = 8
+    {menu_009, 10, 8, 9, 9,  MENU_GLCD(start)},	// selected = 9. Call function start if "enter" event
+    
+    {menu_010, 7, 0,  0,  0,  0},					// selected = 10
+    {menu_011, 7, 7,  12, 11, 0},					// selected = 11
+    {menu_012, 7, 11, 13, 12, param_edit, &counter_param},	// selected = 12
+    {menu_013, 7, 12, 14, 13, latency_stats},		// selected = 13
+    {menu_014, 7, 13, 15, 14, memory_stats},		// selected = 14
+    {menu_015, 7, 14, 16, 17, 0},					// selected = 15
+    {menu_016, 7, 15, 16, 1,  0},					// selected = 16		
+    
+    {menu_017, 1, 17, 17, 15, 0, 0, &device_list},		// selected = 17. Virtual list, the items are provided by main.c
+    
+    {menu_018, 10, 18, 18, 18, 0},					// selected = 18. Grid section, see menu_grids[]
+    {menu_019, 10, 19, 20, 8,  0},					// selected = 19
+    {menu_020, 10, 19, 21, 8,  0},					// selected = 20
+    {menu_021, 10, 20, 22, 8,  0},					// selected = 21
+    {menu_022, 10, 21, 23, 8,  0},					// selected = 22
+    {menu_023, 10, 22, 24, 8,  0},					// selected = 23
+    {menu_024, 10, 23, 25, 8,  0},					// selected = 24
+    {menu_025, 10, 24, 26, 8,  0},					// selected = 25
+    {menu_026, 10, 25, 27, 8,  0},					// selected = 26
+    {menu_027, 10, 26, 27, 8,  0},					// selected = 27
+};
+
+/**
+ * Sections shown as a grid, row-major: 'up' / 'down' links go through the cells as through the rows
+ */
+static MenuGrid menu_grids[] =
+{
+    {18, 3, INITIAL_MAXX / 3},						// Presets, 3 columns
+};
+
+/** ##Menu Handler - send LCD menu string at reference location
+ * 
+ * Set refX and refY to the character format of the display geometry (21x8, 26x16) indexed from 0, 0
+ *
+ * Consider UART was initialized and enabled.
+ * @param refX, refY reference coordinates as for character LCD format (e.g. 21 x 8) indexed from 0, 0.
+ * @param *lcd_menu_items a pointer to the characters in selected menu item to be displayed on the LCD screen
+ * @param add_line if 1 (or just > 1) then complete the row with character given in add_char. If add_line =0 the row would not be completed till the end.
+ * @param add_char character to be used to complete the row after the menu string if add_line >=1.
+ *
+ */
+void serialGLCD_writeMenuString (unsigned char refX, unsigned char refY, const char *lcd_menu_items, unsigned char add_line, char add_char) 
+{
+	unsigned char lcd_i;
+	unsigned char lcd_offset = 0;
+	
+	serialGLCD_goto21x8_XY(refX, refY);
+	
+	lcd_offset = strlen(lcd_menu_items);
+	
+	if (lcd_offset > INITIAL_MAXX) lcd_offset = INITIAL_MAXX;
+	for (lcd_i = lcd_offset; lcd_i; lcd_i--)
+	{
+		serialGLCD_sendChar(*lcd_menu_items++);
+	}
+	if (add_line)
+	{
+		for (lcd_i = INITIAL_MAXX - lcd_offset - refX; lcd_i; lcd_i--) 
+		{
+			serialGLCD_sendChar(add_char);
+		}
+	}
+}
+
+/** ##Menu Handler - clear all registered serial GLCD displays
+ *
+ * Active display is restored afterwards.
+ */
+static void serialGLCD_mirrorClear(void)
+{
+	GLCD_Display *active = serialGLCD_active;
+	GLCD_Display *display;
+	
+	for (display = serialGLCD_displays; display; display = display->next)
+	{
+		serialGLCD_select(display);
+		serialGLCD_clear();
+	}
+	serialGLCD_select(active);
+}
+
+/** ##Menu Handler - send LCD menu string to all registered serial GLCD displays
+ *
+ * - Same row is queued for each display in turn, a row (goto + 21 characters) fits in the transmit queue
+ * - Thus while the first display's row is being transmitted the next display's row is queued,
+ *   both are sent in parallel, each display with its own backpack pacing
+ * - Active display is restored afterwards
+ */
+static void serialGLCD_mirrorWriteMenuString(unsigned char refX, unsigned char refY, const char *lcd_menu_items, unsigned char add_line, char add_char)
+{
+	GLCD_Display *active = serialGLCD_active;
+	GLCD_Display *display;
+	
+	for (display = serialGLCD_displays; display; display = display->next)
+	{
+		serialGLCD_select(display);
+		serialGLCD_writeMenuString(refX, refY, lcd_menu_items, add_line, add_char);
+	}
+	serialGLCD_select(active);
+}
+
+/** ##Menu Handler - compute the frame of a virtual list
+ *
+ * - menu item the list belongs to is the header on the first row, the list items are shown under it
+ * - the window of list items is moved over the list as over the static menu items, selector is kept
+ *   within 'UPPER_SPACE' and 'LOWER_SPACE', only the items in the window are asked for their labels
+ * - rows after the last item are shown empty, thus nothing is left over when the list gets shorter
+ * @param sel Menu item with the virtual list
+ * @param frame Computed frame
+ *
+ */
+static void menu_listFrame(unsigned char sel, MenuFrame *frame)
+{
+	unsigned int count = my_menu[sel].list->count();
+	unsigned char line_cnt;
+	
+	if (count == 0) menu_listIndex = 0;
+	else if (menu_listIndex > count - 1) menu_listIndex = count - 1;
+	
+	frame->header = sel;
+	frame->index = menu_listIndex;
+	frame->first = (frame->index + 1 > UPPER_SPACE) ? frame->index + 1 - UPPER_SPACE : 0;
+	if (frame->first + (DISPLAY_ROWS - 1) > count)
+	{
+		frame->first = (count > DISPLAY_ROWS - 1) ? count - (DISPLAY_ROWS - 1) : 0;
+	}
+	
+	frame->items[0] = sel;
+	for (line_cnt = 1; line_cnt < DISPLAY_ROWS; line_cnt++)
+	{
+		frame->items[line_cnt] = (frame->first + line_cnt - 1 < count) ? MENU_LIST_ROW : MENU_NO_ITEM;
+	}
+	frame->rows = DISPLAY_ROWS;
+	menu_formatRow(frame, 0, frame->row0);
+	frame->valid = 1;
+}
+
+/** ##Menu Handler - grid layout of a section
+ *
+ * @param header Header (first item) of the section
+ * @return grid layout from menu_grids[], 0 if the section is shown one item per row
+ *
+ */
+static MenuGrid *menu_grid(unsigned char header)
+{
+	unsigned char i;
+	
+	for (i = 0; i < sizeof(menu_grids) / sizeof(menu_grids[0]); i++)
+	{
+		if (menu_grids[i].header == header) return &menu_grids[i];
+	}
+	return 0;
+}
+
+/** ##Menu Handler - compute the frame of a grid section
+ *
+ * - header stays on the first row, each following row shows 'columns' items, row-major
+ * - the window is moved over the grid rows as over the static menu items, the row of the selected item
+ *   is kept within 'UPPER_SPACE' and 'LOWER_SPACE'
+ * - rows after the last grid row are shown empty
+ * @param sel Selected menu item
+ * @param frame Frame with 'header' and 'grid' set, completed here
+ *
+ */
+static void menu_gridFrame(unsigned char sel, MenuFrame *frame)
+{
+	unsigned char columns = frame->grid->columns;
+	unsigned char gridRows = (my_menu[frame->header].num_menupoints - 1 + columns - 1) / columns;
+	unsigned char row = (sel - frame->header - 1) / columns;
+	unsigned char first;
+	unsigned char line_cnt;
+	
+	first = (row + 1 > UPPER_SPACE) ? row + 1 - UPPER_SPACE : 0;
+	if (first + (DISPLAY_ROWS - 1) > gridRows)
+	{
+		first = (gridRows > DISPLAY_ROWS - 1) ? gridRows - (DISPLAY_ROWS - 1) : 0;
+	}
+	
+	frame->items[0] = frame->header;
+	for (line_cnt = 1; line_cnt < DISPLAY_ROWS; line_cnt++)
+	{
+		row = first + line_cnt - 1;
+		frame->items[line_cnt] = (row < gridRows) ? frame->header + 1 + row * columns : MENU_NO_ITEM;
+	}
+	frame->rows = DISPLAY_ROWS;
+	menu_formatRow(frame, 0, frame->row0);
+	frame->valid = 1;
+}
+
+/** ##Menu Handler - mark a grid cell, the label is not sent again
+ *
+ * @param frame Frame shown
+ * @param item Menu item of the cell
+ * @param mark SELECTION_CHAR or ' '
+ *
+ */
+static void menu_gridMark(MenuFrame *frame, unsigned char item, char mark)
+{
+	unsigned char columns = frame->grid->columns;
+	unsigned char cell = item - frame->header - 1;
+	char text[2];
+	
+	text[0] = mark;
+	text[1] = 0;
+	menu_display->writeString((cell % columns) * frame->grid->width, 1 + cell / columns - (frame->items[1] - frame->header - 1) / columns, text, 0, ' ');
+}
+
+/** ##Menu Handler - compute the frame shown for a selected menu item
+ *
+ * Frame is the list of menu items shown on the display rows (see show_menu() for the model).
+ * First row is formatted here as well, thus it could be sent right away when the frame is taken from the cache.
+ * @param sel Selected menu item the frame is computed for
+ * @param frame Computed frame
+ *
+ */
+static void menu_frame(unsigned char sel, MenuFrame *frame)
+{
+	unsigned char from = 0;		// from which row of menu points
+	unsigned char till = 0;		// till which row of menu points
+	unsigned char temp = 0;
+	unsigned char line_cnt = 0;
+	unsigned char varDisplay_rows = DISPLAY_ROWS;
+	unsigned char varUpper_space = UPPER_SPACE;
+	
+	frame->selected = sel;
+	frame->rows = 0;
+	frame->valid = 0;
+	frame->grid = 0;
+	
+	if (my_menu[sel].list)
+	{
+		menu_listFrame(sel, frame);
+		return;
+	}
+	
+	// define from and till spec for the menu
+	if (my_menu[sel].num_menupoints < DISPLAY_ROWS) 
+	{
+		varDisplay_rows = my_menu[sel].num_menupoints;
+		varUpper_space = varDisplay_rows - 2;
+	}
+	while (till <= sel)
+	{
+		till += my_menu[till].num_menupoints;
+	}
+	from = till - my_menu[sel].num_menupoints;
+	temp = from;
+	frame->header = temp;
+	till--;
+	
+	frame->grid = menu_grid(temp);
+	if (frame->grid)
+	{
+		menu_gridFrame(sel, frame);
+		return;
+	}
+	
+	if ((sel >= (from + varUpper_space)) && (sel <= (till - LOWER_SPACE))) 
+	{
+		from = sel - varUpper_space;
+		till = from + (varDisplay_rows - 1);
+	} else if (sel < (from + varUpper_space)) {
+		till = from + (varDisplay_rows - 1);
+	} else if (sel == till) {
+		from = till - (varDisplay_rows - 1);
+	} else {
+		frame->valid = 1;	// nothing to show
+		return;
+	}
+	if ((VISIBLE_MENU_HEADER) && (from != temp))
+	{
+		// header is kept on the first row, it replaces the first item of the range
+		frame->items[line_cnt++] = temp;
+		from++;
+	}
+	for (; from <= till; from++)
+	{
+		frame->items[line_cnt++] = from;
+	}
+	frame->rows = line_cnt;
+	if (line_cnt) menu_formatRow(frame, 0, frame->row0);
+	frame->valid = 1;
+}
+
+/** ##Menu Handler - format one row of a frame
+ *
+ * - selected item is marked with SELECTION_CHAR
+ * - header on the first row is shown as it is (if VISIBLE_MENU_HEADER), other items are shifted by one space
+ * - long menu items are cut to the display width
+ * - virtual list item is asked for its label, an empty row after the end of the list is left empty
+ * - grid row shows a cell per item, selected one is marked with SELECTION_CHAR only
+ * @param frame Frame the row belongs to
+ * @param line Row number
+ * @param buffer Formatted row, INITIAL_MAXX + 1 characters
+ *
+ */
+static void menu_formatRow(MenuFrame *frame, unsigned char line, char *buffer)
+{
+	unsigned char item = frame->items[line];
+	
+	if (item == MENU_LIST_ROW)
+	{
+		buffer[0] = menu_rowSelected(frame, line) ? SELECTION_CHAR : ' ';
+		buffer[1] = 0;
+		my_menu[frame->selected].list->label(frame->first + line - 1, buffer + 1, INITIAL_MAXX);
+		buffer[INITIAL_MAXX] = 0;
+	} else if (item == MENU_NO_ITEM) {
+		buffer[0] = 0;
+	} else if (frame->grid && line) {
+		// grid row - cells of 'width' characters from the first item of the row till the end of the section
+		unsigned char end = frame->header + my_menu[frame->header].num_menupoints;
+		unsigned char width = frame->grid->width;
+		unsigned char pos;
+		
+		buffer[0] = 0;
+		for (pos = 0; (pos < INITIAL_MAXX) && (item < end) && (pos / width < frame->grid->columns); pos += width, item++)
+		{
+			snprintf(buffer + pos, INITIAL_MAXX + 1 - pos, "%c%-*.*s", (item == frame->selected) ? SELECTION_CHAR : ' ', width - 1, width - 1, my_menu[item].text);
+		}
+	} else if (menu_rowSelected(frame, line)) {
+		snprintf(buffer, INITIAL_MAXX + 1, "%c%s", SELECTION_CHAR, my_menu[item].text);
+	} else if ((VISIBLE_MENU_HEADER) && (line == 0) && (item == frame->header)) {
+		snprintf(buffer, INITIAL_MAXX + 1, "%s", my_menu[item].text);
+	} else {
+		snprintf(buffer, INITIAL_MAXX + 1, " %s", my_menu[item].text);
+	}
+}
+
+/** ##Menu Handler - is the row of a frame the selected one
+ *
+ * @param frame Frame the row belongs to
+ * @param line Row number
+ * @return non zero if the row shows the selected menu item (or the selected virtual list item)
+ *
+ */
+static unsigned char menu_rowSelected(MenuFrame *frame, unsigned char line)
+{
+	if (frame->items[line] == MENU_LIST_ROW) return (frame->first + line - 1) == frame->index;
+	if (my_menu[frame->selected].list) return 0;
+	if (frame->grid && line) return 0;		// grid cell is marked inside the row
+	return frame->items[line] == frame->selected;
+}
+
+/** ##Menu Handler - show LCD menu on the screen
+ *
+ * Consider the display backend 'menu_display' was initialized (UART for serial GLCD, ports for HD44780).
+ *
+ * Chosen menu item is contained in global variable 'selected'
+ *
+ * Structure of menu handler
+ * - Input base: 
+ *   - how many rows has the display, this is defined in 'DISPLAY_ROWS' macro definition
+ *   - how many rows on the screen has the menu itself (or sub-menu, etc), stored in 'MenuEntry' structure, field 'num_menupoints' 
+ *   - the range within which the selector could be displayed without need to scroll the display
+ *     - 'UPPER_SPACE' and 'LOWER_SPACE'MACROs predefined 
+ *   - in case 'num_menupoints' is less than DISPLAY_ROWS, to ensure unwanted screen scrolling:
+ *     - actual number of rows to be displayed is 'num_menupoints' 
+ *     - 'UPPER_SPACE' is recalculated to keep 2 rows less than the number of rows to be displayed
+ *     - ensure to clear the display when short menu is entered, thus to delete remains from previous menu (header of the last shown menu is kept)
+ *
+ * - Menu handler model: could be represented like the display is a "frame-mask" moved over the indexed menu items list
+ *     - thus have to be defined: 'from' which menu item 'till' which menu item depends of the menu selector 'selected'
+ *         - this should be done within the range of items from the same menu/sub-menu, means the same 'num_menupoints'
+ *     - ensure correct range depends of the usage of 'VISIBLE_MENU_HEADER' and upper and lower spaces
+ *     - show the menu items listed in between 'from' and 'till', show selection marks and control scrolling depending of the valid range
+ * - The frame (which menu item on which row) is computed by menu_frame(), or taken from the speculation cache
+ *   filled by menu_speculate() during idle time. Then the first row goes out on the wire right away.
+ * - Menu item with a virtual list (see MenuList) shows its list instead, 'menu_listIndex' is the selected list item.
+ *   The list is never speculated, its frame depends on 'menu_listIndex' as well.
+ * - Section listed in menu_grids[] is shown as a grid. When the selection moves within the grid rows on the screen
+ *   only the marks of the old and the new cell are sent, not the rows.
+ * 
+ */
+void show_menu(void)
+{
+	static unsigned char lastHeader = MENU_NO_ITEM;
+	MenuFrame frame;
+	MenuFrame *shown = 0;
+	unsigned char line_cnt;
+	char buffer[INITIAL_MAXX + 1];
+	
+	TRACE(TRACE_MENU_START, selected);
+	
+	// take the frame from the speculation cache if it was prepared during idle time
+	if (menu_speculation)
+	{
+		for (line_cnt = 0; line_cnt < MENU_SPECULATION_SLOTS; line_cnt++)
+		{
+			if (menu_specCache[line_cnt].valid && (menu_specCache[line_cnt].selected == selected))
+			{
+				shown = &menu_specCache[line_cnt];
+				break;
+			}
+		}
+	}
+	if (!shown)
+	{
+		menu_frame(selected, &frame);
+		shown = &frame;
+	}
+	
+	// short menu - clear the remains from the previous menu when entered (both could be short on a tall display)
+	if ((my_menu[selected].num_menupoints < DISPLAY_ROWS) && (shown->header != lastHeader))
+	{
+		menu_display->clear();
+	}
+	lastHeader = shown->header;
+	
+	if (shown->grid && (shown->header == menu_gridHeader) && (shown->items[1] == menu_gridFirst))
+	{
+		// grid window did not move - only the marks
+		if (menu_gridSelected != selected)
+		{
+			menu_gridMark(shown, menu_gridSelected, ' ');
+			menu_gridMark(shown, selected, SELECTION_CHAR);
+		}
+	} else {
+		for (line_cnt = 0; line_cnt < shown->rows; line_cnt++)
+		{
+			TRACE(TRACE_ROW_EMIT, line_cnt);
+			if (line_cnt == 0)
+			{
+				menu_display->writeString(0, 0, shown->row0, 1, menu_rowSelected(shown, 0) ? SELECTION_CHAR_END : ' ');
+			} else {
+				menu_formatRow(shown, line_cnt, buffer);
+				menu_display->writeString(0, line_cnt, buffer, 1, menu_rowSelected(shown, line_cnt) ? SELECTION_CHAR_END : ' ');
+			}
+		}
+	}
+	menu_gridHeader = shown->grid ? shown->header : MENU_NO_ITEM;
+	menu_gridFirst = shown->items[1];
+	menu_gridSelected = selected;
+	
+	// speculation cache is built for the next state
+	menu_specBase = MENU_NO_ITEM;
+	
+	// selected label longer than the row scrolls, see menu_marquee(). Labels of a virtual list are cut.
+	menu_marqueeRow = MENU_NO_ITEM;
+	for (line_cnt = 0; line_cnt < shown->rows; line_cnt++)
+	{
+		if (menu_rowSelected(shown, line_cnt) && !my_menu[selected].list && (strlen(my_menu[selected].text) > MENU_MARQUEE_WIDTH))
+		{
+			menu_marqueeRow = line_cnt;
+			menu_marqueeOffset = 0;
+			menu_marqueeNext = timer_millis() + MARQUEE_PAUSE_MS;
+		}
+	}
+	
+	TRACE(TRACE_MENU_END, selected);
+	if (menu_display->flush) menu_display->flush();
+	
+	// latency instrumentation, see menu_latencyStart()
+	if (menu_latencyArmed && !serialGLCD_probe)
+	{
+		unsigned long latency = (serialGLCD_probeTick - menu_latencyStartTick) * TIMER_TICK_US;
+		
+		menu_latencyLast = (latency > 0xFFFF) ? 0xFFFF : (unsigned int)latency;
+		if (menu_latencyCount[menu_latencyMode] == 0xFFFF)
+		{
+			// both halved together, the mean is kept and the sum never exceeds 0xFFFF * 0xFFFF
+			menu_latencySum[menu_latencyMode] >>= 1;
+			menu_latencyCount[menu_latencyMode] >>= 1;
+		}
+		menu_latencySum[menu_latencyMode] += menu_latencyLast;
+		menu_latencyCount[menu_latencyMode]++;
+	}
+	menu_latencyArmed = 0;
+	serialGLCD_probe = 0;
+}
+
+/** ##Menu Handler - speculative pre-render during idle time
+ *
+ * To be called from the main loop while waiting for events.
+ * For the current 'selected' the frames of the likely next states (up, down, enter) are computed,
+ * one candidate per call to keep the main loop responsive.
+ * Candidate equal to the current selection or to an already prepared one is skipped, as well as a virtual list.
+ *
+ */
+void menu_speculate(void)
+{
+	unsigned char candidate;
+	unsigned char slot;
+	
+	if (!menu_speculation) return;
+	if (menu_specBase != selected)
+	{
+		// new state - drop frames prepared for the previous one
+		for (slot = 0; slot < MENU_SPECULATION_SLOTS; slot++) menu_specCache[slot].valid = 0;
+		menu_specBase = selected;
+		menu_specNext = 0;
+	}
+	if (menu_specNext >= MENU_SPECULATION_SLOTS) return;
+	
+	slot = menu_specNext++;
+	switch (slot)
+	{
+		case 0:		candidate = my_menu[selected].up;		break;
+		case 1:		candidate = my_menu[selected].down;		break;
+		default:	candidate = my_menu[selected].enter;	break;
+	}
+	if ((candidate == selected) || my_menu[candidate].list) return;
+	for (unsigned char i = 0; i < slot; i++)
+	{
+		if (menu_specCache[i].valid && (menu_specCache[i].selected == candidate)) return;
+	}
+	menu_frame(candidate, &menu_specCache[slot]);
+}
+
+/** ##Menu Handler - number of places the selection could move through
+ *
+ * Given to rotary_poll(), the encoder acceleration is limited by it.
+ * @param sel Selected menu item
+ * @return number of items of a virtual list, else number of items in the section of 'sel'
+ *
+ */
+unsigned int menu_length(unsigned char sel)
+{
+	if (my_menu[sel].list) return my_menu[sel].list->count();
+	return my_menu[sel].num_menupoints;
+}
+
+/** ##Menu Handler - move the selection by several steps
+ *
+ * Follows the 'up' (steps < 0) or 'down' (steps > 0) links of the menu items, stops at the end of the menu
+ * (an item linked to itself). Used for the accelerated rotary encoder, one redraw for the whole jump.
+ * On a virtual list 'menu_listIndex' is moved instead, the selected menu item stays.
+ * @param sel Selected menu item to start from
+ * @param steps Number of items to move, negative up, positive down
+ * @return Newly selected menu item
+ *
+ */
+unsigned char menu_move(unsigned char sel, int steps)
+{
+	unsigned char next;
+	long index;
+	
+	if (my_menu[sel].list)
+	{
+		index = (long)menu_listIndex + steps;
+		if (index > (long)my_menu[sel].list->count() - 1) index = (long)my_menu[sel].list->count() - 1;
+		if (index < 0) index = 0;
+		menu_listIndex = index;
+		return sel;
+	}
+	for (; steps; steps += (steps < 0) ? 1 : -1)
+	{
+		next = (steps < 0) ? my_menu[sel].up : my_menu[sel].down;
+		if (next == sel) break;
+		sel = next;
+	}
+	return sel;
+}
+
+/** ##Menu Handler - first letter of a virtual list item, case ignored
+ */
+static unsigned char menu_listLetter(MenuList *list, unsigned int index)
+{
+	char letter[2];
+	
+	letter[0] = 0;
+	list->label(index, letter, sizeof(letter));
+	return toupper((unsigned char)letter[0]);
+}
+
+/** ##Menu Handler - build the jump index of a virtual list
+ *
+ * Built on demand, on the first jump in the list and again when its length changed.
+ * Consider the list is sorted: the end of each group is found by a binary search on the first letter,
+ * thus about log2(count) labels per group are asked for, not the whole list.
+ * Groups after MENU_JUMP_GROUPS are not indexed, the last jump goes to the end of the list.
+ * @param list Virtual list to be indexed
+ *
+ */
+static void menu_jumpBuild(MenuList *list)
+{
+	unsigned int count = list->count();
+	unsigned int start = 0;
+	unsigned int low;
+	unsigned int high;
+	unsigned int middle;
+	unsigned char letter;
+	
+	menu_jumpList = list;
+	menu_jumpCount = count;
+	menu_jumpGroups = 0;
+	while ((start < count) && (menu_jumpGroups < MENU_JUMP_GROUPS))
+	{
+		menu_jumpStart[menu_jumpGroups++] = start;
+		letter = menu_listLetter(list, start);
+		
+		// first item with a greater letter in (start, count]
+		low = start + 1;
+		high = count;
+		while (low < high)
+		{
+			middle = low + (high - low) / 2;
+			if (menu_listLetter(list, middle) > letter) high = middle;
+			else low = middle + 1;
+		}
+		start = low;
+	}
+}
+
+/** ##Menu Handler - move the selection by first-letter groups
+ *
+ * Jump mode of menu_move(): a step down selects the first item of the next group,
+ * a step up the first item of the current group (or of the previous one if already there).
+ * - static menu: groups of the section are given by the index generated at build time (charMenuIndex.h)
+ * - virtual list: groups are indexed on demand, see menu_jumpBuild()
+ * Thus any item of a sorted 1000 item list is a few jumps and a few steps away.
+ * @param sel Selected menu item to start from
+ * @param steps Number of groups to move, negative up, positive down
+ * @return Newly selected menu item
+ *
+ */
+unsigned char menu_jump(unsigned char sel, int steps)
+{
+	MenuList *list = my_menu[sel].list;
+	unsigned char group;
+	unsigned char next;
+	
+	if (list)
+	{
+		if ((list != menu_jumpList) || (list->count() != menu_jumpCount)) menu_jumpBuild(list);
+		if (menu_jumpGroups == 0) return sel;
+		for (; steps; steps += (steps < 0) ? 1 : -1)
+		{
+			for (group = menu_jumpGroups - 1; group && (menu_jumpStart[group] > menu_listIndex); group--);
+			if (steps > 0)
+			{
+				menu_listIndex = (group + 1 < menu_jumpGroups) ? menu_jumpStart[group + 1] : menu_jumpCount - 1;
+			} else if (menu_listIndex > menu_jumpStart[group]) {
+				menu_listIndex = menu_jumpStart[group];
+			} else {
+				menu_listIndex = group ? menu_jumpStart[group - 1] : 0;
+			}
+		}
+		return sel;
+	}
+	
+	for (; steps; steps += (steps < 0) ? 1 : -1)
+	{
+		do
+		{
+			next = (steps < 0) ? my_menu[sel].up : my_menu[sel].down;
+			if (next == sel) return sel;
+			sel = next;
+		} while ((sel >= MENU_INDEX_ITEMS) || !(menu_groupStart[sel / 8] & (1 << (sel % 8))));
+	}
+	return sel;
+}
+
+/** ##Menu Handler - follow the "enter" event
+ *
+ * - plain menu item: its 'enter' link is selected
+ * - virtual list: list's 'enter' callback chooses the menu item for the selected list item ('enter' link if no callback or empty list)
+ * - a virtual list entered from another menu item starts at its first item
+ * - a grid is drawn in full by the next show_menu()
+ * The function linked ('fp') to the new selection is called by the caller.
+ * @param sel Selected menu item
+ * @return Newly selected menu item
+ *
+ */
+unsigned char menu_enter(unsigned char sel)
+{
+	MenuList *list = my_menu[sel].list;
+	unsigned char next = my_menu[sel].enter;
+	
+	if (list && list->enter && (menu_listIndex < list->count())) next = list->enter(menu_listIndex);
+	if (my_menu[next].list && (next != sel)) menu_listIndex = 0;
+	menu_gridHeader = MENU_NO_ITEM;		// function called next could draw over the grid
+	return next;
+}
+
+/** ##Menu Handler - marquee of the selected row, one scroll step when due
+ *
+ * To be called from the idle loop, nothing waits here:
+ * - step is skipped until MARQUEE_STEP_MS (MARQUEE_PAUSE_MS at the ends of the label) is over
+ * - step is skipped while the display backend has output queued, thus the queue never fills and input is not delayed
+ * - a step sends a goto and the visible window of the label only, the selection character and other rows stay
+ *
+ */
+void menu_marquee(void)
+{
+	const char *text = my_menu[selected].text;
+	unsigned char length;
+	char window[MENU_MARQUEE_WIDTH + 1];
+	unsigned long now;
+	
+	if (menu_marqueeRow == MENU_NO_ITEM) return;
+	now = timer_millis();
+	if ((long)(now - menu_marqueeNext) < 0) return;
+	if (menu_display->busy && menu_display->busy()) return;
+	
+	length = strlen(text);
+	if (menu_marqueeOffset + MENU_MARQUEE_WIDTH < length)
+	{
+		menu_marqueeOffset++;
+		menu_marqueeNext = now + ((menu_marqueeOffset + MENU_MARQUEE_WIDTH < length) ? MARQUEE_STEP_MS : MARQUEE_PAUSE_MS);
+	} else {
+		menu_marqueeOffset = 0;
+		menu_marqueeNext = now + MARQUEE_PAUSE_MS;
+	}
+	memcpy(window, text + menu_marqueeOffset, MENU_MARQUEE_WIDTH);
+	window[MENU_MARQUEE_WIDTH] = 0;
+	menu_display->writeString(1, menu_marqueeRow, window, 0, ' ');
+}
+
+/** ##Menu Handler - latency instrumentation, event occurred
+ *
+ * To be called when an input event causes menu update. Time from this call to the first byte
+ * of the new screen on the wire is measured in show_menu() and accumulated separately for
+ * speculation enabled and disabled.
+ *
+ */
+void menu_latencyStart(void)
+{
+	menu_latencyStartAt(timer_ticks());
+}
+
+/** ##Menu Handler - latency instrumentation, event occurred earlier
+ *
+ * As menu_latencyStart(), the event time is given, e.g. the first detent of an encoder spin (see rotary_eventTicks()),
+ * thus the debouncing and the collecting of a spin are measured as well.
+ * @param ticks Time of the event, timer ticks (see timer_ticks())
+ *
+ */
+void menu_latencyStartAt(unsigned long ticks)
+{
+	menu_latencyStartTick = ticks;
+	menu_latencyMode = menu_speculation ? 1 : 0;
+	menu_latencyArmed = 1;
+	serialGLCD_probe = 1;
+}
@@ -1,124 +1,252 @@
-﻿/*
- * charMenu.h
- *
- * \author Simeon Neykov
- */ 
-
-#ifndef CHARMENU_H_
-#define CHARMENU_H_
-
-#include <avr/io.h>
-#include "main.h"
-#include "USART.h"
-#include "serialGLCD.h"
-
-//#define DISPLAY_16x4               /**< Define display type 16x4.  */
-//#define DISPLAY_20x4             /**< Define display type 20x4.  */
-//#define DISPLAY_16x2             /**< Define display type 16x2.  */
-//#define DISPLAY_20x2             /**< Define display type 20x2.  */
-#define DISPLAY_21x8             /**< Define display type 21x8.  */
-
-/** \brief Define whether menu header is always visible.
- * 
- * First row of the menu could be reserved for menu header.
- *
- * Use flag TRUE to keep menu header always visible.
- * If flag FALSE is used, then menu header will shift accordingly
- * depending of the selected menu item.
-*/
-#define VISIBLE_MENU_HEADER TRUE
-
-/** 
- * Define selection symbols
- */
-#define SELECTION_CHAR      '>'
-#define SELECTION_CHAR_END  '<'
-
-#ifdef DISPLAY_16x4
-    #define DISPLAY_ROWS    4
-    #define UPPER_SPACE     2
-    #define LOWER_SPACE     1
-    #define INITIAL_MAXX    16
-    #define INITIAL_MAXY    4
-    #define START_ROW3      0x10
-    #define START_ROW4      0x50
-#endif
-
-#ifdef DISPLAY_20x4
-    #define DISPLAY_ROWS    4
-    #define UPPER_SPACE     2
-    #define LOWER_SPACE     1
-    #define INITIAL_MAXX    20
-    #define INITIAL_MAXY    4
-    #define START_ROW3      0x14
-    #define START_ROW4      0x54
-#endif
-
-#ifdef DISPLAY_21x8
-	#define DISPLAY_ROWS    8	///< this is copied into a variable and handled depends of num_menupoints
-	#define UPPER_SPACE     6	///< this is copied into a variable and handled depends of num_menupoints. Target is UPPER_SPACE = DISPLAY_ROWS - 2
-	#define LOWER_SPACE     1
-	#define INITIAL_MAXX    21
-	#define INITIAL_MAXY    8	
-#endif
-
-#ifdef DISPLAY_16x2
-    #define DISPLAY_ROWS    2
-    #define UPPER_SPACE     1
-    #define LOWER_SPACE     0
-    #define INITIAL_MAXX    16
-    #define INITIAL_MAXY    2
-    #define START_ROW3      0x00
-    #define START_ROW4      0x40
-#endif
-
-#ifdef DISPLAY_20x2
-    #define DISPLAY_ROWS    2
-    #define UPPER_SPACE     1
-    #define LOWER_SPACE     0
-    #define INITIAL_MAXX    20
-    #define INITIAL_MAXY    2
-    #define START_ROW3      0x00
-    #define START_ROW4      0x40
-#endif
-
-
-/**
- * A structure to represent LCD menu 
- */
-typedef const struct MenuStructure {
-	/*@{*/
-    const char *text;				/**< gives the menu item to be displayed */
-	/*@}*/
-	  /**
-	   * @name num_menupoints is linked with DISPLAY_ROWS and UPPER_SPACE
-       */
-	/*@{*/	
-    unsigned char num_menupoints;	/**< tells how many menu items within selected menu or sub-menu */
-	/*@}*/
-	/*@{*/
-	  /**
-	   * @name up, down, enter are linked with respective event handler (button, encoder, etc)
-       */
-    unsigned char up;				/**< tells what to be selected in case of an event "up" (button, rotary encoder, etc)		*/
-    unsigned char down;				/**< tells what to be selected in case of an event "down" (button, rotary encoder, etc)		*/
-    unsigned char enter;			/**< tells what to be selected in case of an event "enter" (button, rotary encoder, etc)	*/
-	/*@}*/
-	/*@{*/
-    void ( *fp ) (void);			/**< pointer to predefined function to call in case of an event "enter" (button, rotary encoder, etc). No function is called if 0 is placed. */
-	/*@}*/
-}MenuEntry;
-
-extern MenuEntry my_menu[];
-extern unsigned char selected;
-
-//extern void start (void);
-void show_menu(void);
-void serialGLCD_writeMenuString (unsigned char refX, unsigned char refY, const char *lcd_menu_items, unsigned char add_line, char add_char);
-//extern void wait_while_UART0_is_busy();
-//extern void serialGLCD_gotoPixel_XY(unsigned char pixelX, unsigned char pixelY);
-//extern void serialGLCD_goto21x8_XY(unsigned char refX, unsigned char refY);
-//extern void serialGLCD_clear();
-
-
+﻿/*
+ * charMenu.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef CHARMENU_H_
+#define CHARMENU_H_
+
+#include <avr/io.h>
+#include "main.h"
+#include "USART.h"
+#include "serialGLCD.h"
+
+/** \brief Menu display type, HD44780 character LCD or serial GLCD.
+ * 
+ * Could be given on the command line as well (e.g. -DDISPLAY_20x4), serial GLCD if none is given.
+ */
+//#define DISPLAY_16x4               /**< Define display type 16x4.  */
+//#define DISPLAY_20x4             /**< Define display type 20x4.  */
+//#define DISPLAY_16x2             /**< Define display type 16x2.  */
+//#define DISPLAY_20x2             /**< Define display type 20x2.  */
+#if !defined(DISPLAY_16x4) && !defined(DISPLAY_20x4) && !defined(DISPLAY_16x2) && !defined(DISPLAY_20x2)
+#define DISPLAY_GLCD             /**< Define display type serial GLCD, 21x8 or 26x16 as given by its geometry descriptor (serialGLCD.h).  */
+#endif
+
+/** 
+ * Handler drawing with the serial GLCD widgets (text layout, text entry, plot, bar), placed in my_menu[] through this macro.
+ * On the character LCDs no function is called, the item does nothing. Text handlers write through menu_display and serve any display.
+ */
+#ifdef DISPLAY_GLCD
+#define MENU_GLCD(handler)	handler
+#else
+#define MENU_GLCD(handler)	0
+#endif
+
+/** \brief Define whether menu header is always visible.
+ * 
+ * First row of the menu could be reserved for menu header.
+ *
+ * Use flag TRUE to keep menu header always visible.
+ * If flag FALSE is used, then menu header will shift accordingly
+ * depending of the selected menu item.
+*/
+#define VISIBLE_MENU_HEADER TRUE
+
+/** 
+ * Define selection symbols
+ */
+#define SELECTION_CHAR      '>'
+#define SELECTION_CHAR_END  '<'
+
+/** 
+ * Marquee of the selected row: label longer than the row scrolls horizontally, see menu_marquee()
+ */
+#define MARQUEE_STEP_MS     300			///< Given in ms. Time of one character scroll step
+#define MARQUEE_PAUSE_MS    1500		///< Given in ms. Pause with the beginning or the end of the label shown
+
+#ifdef DISPLAY_16x4
+    #define DISPLAY_ROWS    4
+    #define UPPER_SPACE     2
+    #define LOWER_SPACE     1
+    #define INITIAL_MAXX    16
+    #define INITIAL_MAXY    4
+    #define START_ROW3      0x10
+    #define START_ROW4      0x50
+#endif
+
+#ifdef DISPLAY_20x4
+    #define DISPLAY_ROWS    4
+    #define UPPER_SPACE     2
+    #define LOWER_SPACE     1
+    #define INITIAL_MAXX    20
+    #define INITIAL_MAXY    4
+    #define START_ROW3      0x14
+    #define START_ROW4      0x54
+#endif
+
+#ifdef DISPLAY_GLCD
+	#define DISPLAY_ROWS    GLCD_ROWS			///< this is copied into a variable and handled depends of num_menupoints
+	#define UPPER_SPACE     (GLCD_ROWS - 2)		///< this is copied into a variable and handled depends of num_menupoints. Target is UPPER_SPACE = DISPLAY_ROWS - 2
+	#define LOWER_SPACE     1
+	#define INITIAL_MAXX    GLCD_COLS
+	#define INITIAL_MAXY    GLCD_ROWS
+#endif
+
+#ifdef DISPLAY_16x2
+    #define DISPLAY_ROWS    2
+    #define UPPER_SPACE     1
+    #define LOWER_SPACE     0
+    #define INITIAL_MAXX    16
+    #define INITIAL_MAXY    2
+    #define START_ROW3      0x00
+    #define START_ROW4      0x40
+#endif
+
+#ifdef DISPLAY_20x2
+    #define DISPLAY_ROWS    2
+    #define UPPER_SPACE     1
+    #define LOWER_SPACE     0
+    #define INITIAL_MAXX    20
+    #define INITIAL_MAXY    2
+    #define START_ROW3      0x00
+    #define START_ROW4      0x40
+#endif
+
+
+/**
+ * A structure to represent a virtual list, items are not stored but provided by the application on request
+ *
+ * Only the rows in the visible window are asked for, thus memory and redraw cost do not depend on the list length.
+ */
+typedef const struct ListStructure {
+	/*@{*/
+	unsigned int ( *count ) (void);	/**< number of items of the list, could change while the list is shown */
+	void ( *label ) (unsigned int index, char *buffer, unsigned char size);	/**< writes the label of item 'index' into 'buffer' of 'size' bytes, terminated */
+	unsigned char ( *enter ) (unsigned int index);	/**< called in case of an event "enter" on item 'index', returns the menu item to be selected. 'enter' of the menu item is selected if 0 is placed. */
+	/*@}*/
+}MenuList;
+
+/**
+ * A structure to represent LCD menu 
+ */
+typedef const struct MenuStructure {
+	/*@{*/
+    const char *text;				/**< gives the menu item to be displayed */
+	/*@}*/
+	  /**
+	   * @name num_menupoints is linked with DISPLAY_ROWS and UPPER_SPACE
+       */
+	/*@{*/	
+    unsigned char num_menupoints;	/**< tells how many menu items within selected menu or sub-menu */
+	/*@}*/
+	/*@{*/
+	  /**
+	   * @name up, down, enter are linked with respective event handler (button, encoder, etc)
+       */
+    unsigned char up;				/**< tells what to be selected in case of an event "up" (button, rotary encoder, etc)		*/
+    unsigned char down;				/**< tells what to be selected in case of an event "down" (button, rotary encoder, etc)		*/
+    unsigned char enter;			/**< tells what to be selected in case of an event "enter" (button, rotary encoder, etc)	*/
+	/*@}*/
+	/*@{*/
+    void ( *fp ) (const void *context);	/**< pointer to predefined function to call in case of an event "enter" (button, rotary encoder, etc). No function is called if 0 is placed. The item stays selected when the function returns. */
+    const void *context;			/**< passed to 'fp', e.g. a MenuParam descriptor, thus one function serves many items. 0 if the function needs none. */
+	/*@}*/
+	/*@{*/
+	MenuList *list;					/**< virtual list shown under this item as header, see show_menu(). Menu item is a plain one if 0 is placed (or omitted). */
+	/*@}*/
+}MenuEntry;
+
+/**
+ * A structure to represent a parameter edited by the generic handler param_edit() (see main.c), given as the item 'context'
+ *
+ * One handler serves any number of parameter items, an item costs its descriptor only.
+ * Descriptors are to be placed in flash (PROGMEM), param_edit() reads them with pgm_read_*(), no SRAM is taken.
+ */
+typedef const struct ParamStructure {
+	/*@{*/
+	const char *title;				/**< shown on the first row, e.g. "Count (0 - 100)" */
+	unsigned char *value;			/**< bound variable, changed in place */
+	unsigned char min;				/**< lowest value, the encoder stops here */
+	unsigned char max;				/**< highest value, the encoder stops here */
+	void ( *apply ) (unsigned char value);	/**< called after each change, e.g. to set the backlight right away. Nothing is called if 0 is placed. */
+	/*@}*/
+}MenuParam;
+
+/**
+ * A structure to represent a display backend used by the menu handler
+ *
+ * show_menu() doesn't know the display type, it only clears the screen and writes rows through the selected backend.
+ */
+typedef const struct DisplayStructure {
+	/*@{*/
+	void ( *clear ) (void);			/**< clears the whole screen */
+	void ( *writeString ) (unsigned char refX, unsigned char refY, const char *text, unsigned char add_line, char add_char);	/**< writes a row at character coordinates, see serialGLCD_writeMenuString() */
+	void ( *flush ) (void);			/**< sends everything still queued, called at the end of show_menu(). No function is called if 0 is placed. */
+	unsigned char ( *busy ) (void);	/**< non zero while output is still queued, background updates (marquee) wait for it. Never busy if 0 is placed. */
+	/*@}*/
+}MenuDisplay;
+
+/**
+ * A structure to represent a grid layout of a menu section, items are placed row-major in cells of fixed width
+ *
+ * Sections not listed in menu_grids[] (charMenu.c) are shown one item per row.
+ */
+typedef const struct GridStructure {
+	/*@{*/
+	unsigned char header;			/**< header (first item) of the section */
+	unsigned char columns;			/**< cells per row */
+	unsigned char width;			/**< cell width in characters, the selection character included. Longer labels are cut. */
+	/*@}*/
+}MenuGrid;
+
+#define MENU_SPECULATION_SLOTS	3		///< frames prepared in advance: up, down, enter
+#define MENU_NO_ITEM			255		///< not a menu item index
+#define MENU_LIST_ROW			254		///< row of a frame showing a virtual list item
+#define MENU_JUMP_GROUPS		27		///< first-letter groups indexed for a virtual list (letters and one more), see menu_jump()
+#define MENU_MARQUEE_WIDTH		(INITIAL_MAXX - 1)	///< visible part of the selected label, the selection character takes the first column
+
+/**
+ * A structure to represent a frame: which menu items are shown on which display rows
+ */
+typedef struct FrameStructure {
+	/*@{*/
+	unsigned char selected;					/**< selected menu item the frame is computed for */
+	unsigned char header;					/**< header (first item) of the menu / sub-menu */
+	unsigned char rows;						/**< number of rows to be shown */
+	unsigned char valid;					/**< frame is computed */
+	unsigned char items[DISPLAY_ROWS];		/**< menu item shown on each row (first cell of a grid row), MENU_LIST_ROW for a virtual list item */
+	MenuGrid *grid;							/**< grid layout of the section, 0 if one item per row */
+	unsigned int first;						/**< virtual list: item shown on the second row */
+	unsigned int index;						/**< virtual list: selected item */
+	char row0[INITIAL_MAXX + 1];			/**< first row formatted in advance */
+	/*@}*/
+}MenuFrame;
+
+extern MenuEntry my_menu[];
+extern unsigned char selected;
+extern MenuDisplay *menu_display;
+extern MenuDisplay serialGLCD_menuDisplay;
+extern MenuDisplay serialGLCD_mirrorMenuDisplay;
+
+//extern void start (void);
+extern unsigned int menu_listIndex;
+extern unsigned char menu_speculation;
+extern unsigned int menu_latencyLast;
+extern unsigned long menu_latencySum[2];
+extern unsigned int menu_latencyCount[2];
+
+void show_menu(void);
+void menu_speculate(void);
+unsigned int menu_length(unsigned char sel);
+unsigned char menu_move(unsigned char sel, int steps);
+unsigned char menu_jump(unsigned char sel, int steps);
+unsigned char menu_enter(unsigned char sel);
+void menu_marquee(void);
+void menu_latencyStart(void);
+void menu_latencyStartAt(unsigned long ticks);
+void serialGLCD_writeMenuString (unsigned char refX, unsigned char refY, const char *lcd_menu_items, unsigned char add_line, char add_char);
+
+// virtual lists of the application
+extern MenuList device_list;
+extern MenuParam counter_param;
+extern MenuParam backlight_param;
+
+//extern void wait_while_UART0_is_busy();
+//extern void serialGLCD_gotoPixel_XY(unsigned char pixelX, unsigned char pixelY);
+//extern void serialGLCD_goto21x8_XY(unsigned char refX, unsigned char refY);
+//extern void serialGLCD_clear();
+
+
 #endif /* CHARMENU_H_ */
\ No newline at end of file
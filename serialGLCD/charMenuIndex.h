@@ -0,0 +1,18 @@
+﻿/*
+ * charMenuIndex.h
+ *
+ * Generated by tools/menuIndex from charMenu.c, do not edit.
+ */
+
+#ifndef CHARMENUINDEX_H_
+#define CHARMENUINDEX_H_
+
+#define MENU_INDEX_ITEMS	28		///< number of menu items indexed
+
+/**
+ * First-letter groups of the static menu, a bit per menu item (item 0 is bit 0 of the first byte).
+ * Set on the first item of a group, see menu_jump().
+ */
+#define MENU_GROUP_STARTS	{ 0xFE, 0xFA, 0xF9, 0x0F }
+
+#endif /* CHARMENUINDEX_H_ */
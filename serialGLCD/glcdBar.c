@@ -0,0 +1,110 @@
+﻿/** \page pageBar Progress Bar and Gauge Widgets
+ * 
+ * ##Progress bar and gauge on the serial GLCD, updated by delta region only
+ *
+ * glcdBar.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Widget keeps the last drawn fill level (in pixels)
+ * - On update only the region between the old and the new level is drawn (level goes up) or erased (level goes down)
+ * - Thus each update is a single serialGLCD_drawBox command (7 bytes) or nothing if the level in pixels is unchanged,
+ *   cheap enough to be called from inside busy handlers at high rates
+ *
+ */
+
+#include "main.h"
+#include "serialGLCD.h"
+#include "glcdBar.h"
+
+/** ##Bar - draw or erase the fill between two levels
+ * 
+ * @param from, till Levels in pixels, from < till. Pixels from 'from' to 'till - 1' are drawn / erased.
+ * @param draw 1 to draw, 0 to erase
+ *
+ */
+static void glcdBar_fill(BarWidget *bar, unsigned char from, unsigned char till, unsigned char draw)
+{
+	unsigned char fillX = bar->left + 2;
+	unsigned char fillY = bar->top + 2;
+	
+	if (bar->orientation == BAR_VERTICAL)
+	{
+		// gauge is filled from the bottom
+		unsigned char bottomY = fillY + bar->length - 1;
+		serialGLCD_drawBox(fillX, bottomY - (till - 1), fillX + BAR_FILL_WIDTH - 1, bottomY - from, draw);
+	} else {
+		serialGLCD_drawBox(fillX + from, fillY, fillX + till - 1, fillY + BAR_FILL_WIDTH - 1, draw);
+	}
+}
+
+/** ##Bar - initialization
+ * 
+ * Consider UART was initialized and enabled.
+ *
+ * Draws the frame and erases the fill area, the bar is shown empty.
+ * @param bar Widget to be initialized
+ * @param left, top Pixel coordinates of the upper left corner of the frame
+ * @param length Fill length in pixels, limited to fit on the display
+ * @param orientation BAR_HORIZONTAL (progress bar) or BAR_VERTICAL (gauge)
+ * @param minValue, maxValue Values shown as an empty and a full bar
+ *
+ */
+void glcdBar_init(BarWidget *bar, unsigned char left, unsigned char top, unsigned char length, unsigned char orientation, int minValue, int maxValue)
+{
+	unsigned char maxLength = (orientation == BAR_VERTICAL) ? INITIAL_pixel_MAXY : INITIAL_pixel_MAXX;
+	unsigned char origin = (orientation == BAR_VERTICAL) ? top : left;
+	
+	// check the range, frame is 4 pixels longer than the fill
+	if (origin > maxLength - 4) origin = 0;
+	if (length > maxLength - origin - 3) length = maxLength - origin - 3;
+	if (length == 0) length = 1;
+	if (orientation == BAR_VERTICAL) top = origin; else left = origin;
+	if (maxValue <= minValue) maxValue = minValue + 1;
+	
+	bar->left = left;
+	bar->top = top;
+	bar->length = length;
+	bar->orientation = orientation;
+	bar->minValue = minValue;
+	bar->maxValue = maxValue;
+	bar->level = 0;
+	
+	if (orientation == BAR_VERTICAL)
+	{
+		serialGLCD_drawBox(left, top, left + BAR_FILL_WIDTH + 3, top + length + 3, 1);
+	} else {
+		serialGLCD_drawBox(left, top, left + length + 3, top + BAR_FILL_WIDTH + 3, 1);
+	}
+	glcdBar_fill(bar, 0, length, 0);
+}
+
+/** ##Bar - update to a new value
+ * 
+ * Consider UART was initialized and enabled.
+ *
+ * - new value is converted to a fill level in pixels, values out of the range are clamped
+ * - only the delta region between the last drawn and the new level is sent
+ *
+ */
+void glcdBar_update(BarWidget *bar, int value)
+{
+	unsigned char level;
+	
+	if (value <= bar->minValue) 
+	{
+		level = 0;
+	} else if (value >= bar->maxValue) {
+		level = bar->length;
+	} else {
+		level = (unsigned char)(((long)(value - bar->minValue) * bar->length) / ((long)bar->maxValue - bar->minValue));
+	}
+	
+	if (level > bar->level)
+	{
+		glcdBar_fill(bar, bar->level, level, 1);
+	} else if (level < bar->level) {
+		glcdBar_fill(bar, level, bar->level, 0);
+	}
+	bar->level = level;
+}
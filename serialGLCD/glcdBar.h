@@ -0,0 +1,41 @@
+﻿/*
+ * glcdBar.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef GLCDBAR_H_
+#define GLCDBAR_H_
+
+#include "serialGLCD.h"
+
+/*@{*/
+#define BAR_HORIZONTAL		0				///< progress bar, filled from left to right
+#define BAR_VERTICAL		1				///< gauge, filled from bottom to top
+#define BAR_FILL_WIDTH		2				///< fill thickness in pixels. Backpack's box command draws an outline, a box 2 pixels thick is a solid fill
+/*@}*/
+
+/**
+ * A structure to represent a progress bar or a gauge
+ * 
+ * The frame takes 1 pixel plus 1 pixel gap on each side of the fill,
+ * thus the widget is BAR_FILL_WIDTH + 4 pixels thick.
+ */
+typedef struct BarStructure {
+	/*@{*/
+	unsigned char left;				/**< pixel X of the upper left corner of the frame */
+	unsigned char top;				/**< pixel Y of the upper left corner of the frame */
+	unsigned char length;			/**< fill length in pixels (frame is 4 pixels longer) */
+	unsigned char orientation;		/**< BAR_HORIZONTAL or BAR_VERTICAL */
+	/*@}*/
+	/*@{*/
+	int minValue;					/**< value shown as an empty bar */
+	int maxValue;					/**< value shown as a full bar */
+	unsigned char level;			/**< last drawn fill level in pixels, 0 .. length */
+	/*@}*/
+}BarWidget;
+
+void glcdBar_init(BarWidget *bar, unsigned char left, unsigned char top, unsigned char length, unsigned char orientation, int minValue, int maxValue);
+void glcdBar_update(BarWidget *bar, int value);
+
+#endif /* GLCDBAR_H_ */
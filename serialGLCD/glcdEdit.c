@@ -0,0 +1,166 @@
+﻿/** \page pageEdit Text Entry Widget
+ *
+ * ##Text entry with the rotary encoder and the enter button
+ *
+ * glcdEdit.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - The encoder cycles the character at the caret through the alphabet of the field, enter moves the caret to
+ *   the next character, enter on the last character commits the text
+ * - Each step sends only the changed character (a goto and the character, 7 bytes), a caret move only erases
+ *   the caret line and draws it at the next character, a blink toggles the caret line
+ * - Caret blinks with a software timer (see timerWheel.c), nothing waits for it. The caret is shown steadily
+ *   while the text is being changed, the blink restarts after each step.
+ *
+ * Example, 16 characters edited at row 2:
+ *
+ *		static char name[17] = "DEVICE";
+ *		static EditWidget edit;
+ *		glcdEdit_init(&edit, 2, 2, 16, EDIT_ALPHABET_NAME, name);
+ *		glcdEdit_show(&edit);
+ *		... glcdEdit_step(&edit, rotary_poll(sizeof(EDIT_ALPHABET_NAME) - 1)); if enter: if (glcdEdit_next(&edit)) done;
+ *		... timerWheel_service(); serialGLCD_service();
+ *		glcdEdit_close(&edit);
+ *
+ */
+
+#include <string.h>
+#include "main.h"
+#include "serialGLCD.h"
+#include "glcdEdit.h"
+
+/** ##Text entry - draw or erase the caret line under a character
+ */
+static void glcdEdit_caret(EditWidget *edit, unsigned char position, unsigned char draw)
+{
+	unsigned char left = GLCD_CELL_X(edit->x + position);
+
+	serialGLCD_drawLine(left, GLCD_CELL_Y(edit->y + 1), left + EDIT_CARET_WIDTH - 1, GLCD_CELL_Y(edit->y + 1), draw);
+}
+
+/** ##Text entry - caret blink, software timer callback
+ */
+static void glcdEdit_blink(void *context)
+{
+	EditWidget *edit = (EditWidget *)context;
+
+	edit->caretShown = !edit->caretShown;
+	glcdEdit_caret(edit, edit->caret, edit->caretShown);
+}
+
+/** ##Text entry - caret shown, the blink starts over
+ */
+static void glcdEdit_steady(EditWidget *edit)
+{
+	if (!edit->caretShown)
+	{
+		glcdEdit_caret(edit, edit->caret, 1);
+		edit->caretShown = 1;
+	}
+	timerWheel_arm(&edit->blink, EDIT_BLINK_MS, EDIT_BLINK_MS, glcdEdit_blink, edit);
+}
+
+/** ##Text entry - initialization
+ *
+ * Nothing is sent. The text is completed with the first character of the alphabet up to 'length'.
+ * @param edit Widget to be initialized
+ * @param x, y Position of the first character, character format indexed from 0, 0. The row below is taken by the caret.
+ * @param length Number of characters, limited to fit on the row
+ * @param alphabet Characters the encoder cycles through, e.g. EDIT_ALPHABET_NAME
+ * @param text Text to be edited, at least 'length' + 1 characters
+ *
+ */
+void glcdEdit_init(EditWidget *edit, unsigned char x, unsigned char y, unsigned char length, const char *alphabet, char *text)
+{
+	unsigned char i;
+
+	// check the range
+	if (x > GLCD_COLS - 1) x = 0;
+	if (y > GLCD_ROWS - 2) y = 0;
+	if (length > GLCD_COLS - x) length = GLCD_COLS - x;
+	if (length == 0) length = 1;
+
+	edit->x = x;
+	edit->y = y;
+	edit->length = length;
+	edit->alphabet = alphabet;
+	edit->text = text;
+	edit->caret = 0;
+	edit->caretShown = 0;
+	edit->blink.armed = 0;
+	for (i = strlen(text); i < length; i++) text[i] = alphabet[0];
+	text[length] = 0;
+}
+
+/** ##Text entry - draw the whole field and start the caret
+ *
+ * Consider UART was initialized and enabled.
+ * @param edit Initialized widget
+ *
+ */
+void glcdEdit_show(EditWidget *edit)
+{
+	serialGLCD_goto21x8_XY(edit->x, edit->y);
+	serialGLCD_sendString(edit->text);
+	edit->caretShown = 0;
+	glcdEdit_steady(edit);
+}
+
+/** ##Text entry - cycle the character at the caret
+ *
+ * Only the character cell is sent. A character not in the alphabet is taken as its first character.
+ * @param edit Shown widget
+ * @param steps Characters to move in the alphabet, negative backward, wraps around
+ *
+ */
+void glcdEdit_step(EditWidget *edit, int steps)
+{
+	const char *found;
+	int size = strlen(edit->alphabet);
+	int index;
+
+	if (!steps || !size) return;
+	found = strchr(edit->alphabet, edit->text[edit->caret]);
+	index = found ? found - edit->alphabet : 0;
+	index = (index + steps) % size;
+	if (index < 0) index += size;
+	edit->text[edit->caret] = edit->alphabet[index];
+
+	serialGLCD_goto21x8_XY(edit->x + edit->caret, edit->y);
+	serialGLCD_sendChar(edit->text[edit->caret]);
+	glcdEdit_steady(edit);
+}
+
+/** ##Text entry - caret to the next character, or commit
+ *
+ * @param edit Shown widget
+ * @return 1 if the caret was on the last character: the text is committed and the caret removed, 0 otherwise
+ *
+ */
+unsigned char glcdEdit_next(EditWidget *edit)
+{
+	if (edit->caretShown) glcdEdit_caret(edit, edit->caret, 0);
+	edit->caretShown = 0;
+	if (edit->caret + 1 >= edit->length)
+	{
+		timerWheel_cancel(&edit->blink);
+		return 1;
+	}
+	edit->caret++;
+	glcdEdit_steady(edit);
+	return 0;
+}
+
+/** ##Text entry - stop the caret
+ *
+ * To be called when the field is left without the commit, the blink timer is not left armed.
+ * @param edit Shown widget
+ *
+ */
+void glcdEdit_close(EditWidget *edit)
+{
+	timerWheel_cancel(&edit->blink);
+	if (edit->caretShown) glcdEdit_caret(edit, edit->caret, 0);
+	edit->caretShown = 0;
+}
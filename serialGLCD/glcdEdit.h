@@ -0,0 +1,46 @@
+﻿/*
+ * glcdEdit.h
+ *
+ * \author Simeon Neykov
+ */
+
+#ifndef GLCDEDIT_H_
+#define GLCDEDIT_H_
+
+#include "serialGLCD.h"
+#include "timerWheel.h"
+
+/*@{*/
+#define EDIT_BLINK_MS		500				///< Given in ms. Caret blink half period
+#define EDIT_CARET_WIDTH	5				///< caret line under the character, pixels (the font is 5 pixels wide)
+#define EDIT_ALPHABET_NAME	" ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-"	///< alphabet for names and tags
+/*@}*/
+
+/**
+ * A structure to represent a text entry field, edited in place one character at a time
+ *
+ * Caret is a line on the top pixel row of the character row below the field, thus writing a character
+ * does not erase it. The row below the field is to be left empty.
+ */
+typedef struct EditStructure {
+	/*@{*/
+	unsigned char x;				/**< column of the first character, character format */
+	unsigned char y;				/**< row of the field, character format */
+	unsigned char length;			/**< number of characters */
+	const char *alphabet;			/**< characters cycled through at the caret, in order */
+	char *text;						/**< text edited, 'length' characters plus the terminating 0 */
+	/*@}*/
+	/*@{*/
+	unsigned char caret;			/**< position of the caret, 0 .. length - 1 */
+	unsigned char caretShown;		/**< caret line is drawn (blink phase) */
+	TimerWheelTimer blink;			/**< caret blink timer */
+	/*@}*/
+}EditWidget;
+
+void glcdEdit_init(EditWidget *edit, unsigned char x, unsigned char y, unsigned char length, const char *alphabet, char *text);
+void glcdEdit_show(EditWidget *edit);
+void glcdEdit_step(EditWidget *edit, int steps);
+unsigned char glcdEdit_next(EditWidget *edit);
+void glcdEdit_close(EditWidget *edit);
+
+#endif /* GLCDEDIT_H_ */
@@ -0,0 +1,193 @@
+﻿/** \page pagePlot Streaming Plot Widget
+ * 
+ * ##Live time-series plot on the serial GLCD
+ *
+ * glcdPlot.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Samples are kept in a fixed size ring buffer, one sample per pixel column
+ * - Plot works in sweep mode: a cursor column runs from left to right and wraps around,
+ *   the trace left of the cursor is the newest one, right of the cursor is the oldest one
+ * - Backpack has no scroll command, a scrolling plot would need to redraw all the columns per sample,
+ *   in sweep mode each new sample touches two columns only:
+ *     - erase the column ahead of the cursor (this is the visible sweep gap)
+ *     - draw one line segment from the previous sample to the new one
+ * - Cost per sample: 2 x drawLine = 14 bytes queued for the display (see serialGLCD.c), the caller does not wait
+ *   unless the transmit queue is full. The queue sends them in ~2ms of link time: 14 bytes at 115200 baud and
+ *   1ms pacing after the first line. At 20 samples per second the link is ~4% busy. Measured by the
+ *   plot example (plot_demo() in main.c) in host/scripts/plot.txt.
+ *
+ */
+
+#include <limits.h>
+#include "main.h"
+#include "serialGLCD.h"
+#include "glcdPlot.h"
+
+/** ##Plot - scale a sample to pixel Y
+ * 
+ * Sample equal to minY is at the bottom row of the plot, sample equal to maxY is at the top row.
+ * Samples out of the range are clamped to the plot edges.
+ *
+ */
+static unsigned char glcdPlot_scale(PlotWidget *plot, int sample)
+{
+	long offset;
+	
+	if (sample <= plot->minY) return plot->top + plot->height - 1;
+	if (sample >= plot->maxY) return plot->top;
+	offset = (((long)sample - plot->minY) * (plot->height - 1)) / ((long)plot->maxY - plot->minY);
+	return plot->top + plot->height - 1 - (unsigned char)offset;
+}
+
+/** ##Plot - erase one pixel column of the plot area
+ *
+ */
+static void glcdPlot_eraseColumn(PlotWidget *plot, unsigned char column)
+{
+	unsigned char pixelX = plot->left + column;
+	
+	serialGLCD_drawLine(pixelX, plot->top, pixelX, plot->top + plot->height - 1, 0);
+}
+
+/** ##Plot - draw the segment ending at a specified column
+ *
+ * First column of the plot has no predecessor on the screen, then only the sample pixel is set.
+ *
+ */
+static void glcdPlot_drawSegment(PlotWidget *plot, unsigned char column, unsigned char fromPixelY, unsigned char toPixelY)
+{
+	unsigned char pixelX = plot->left + column;
+	
+	if (column)
+	{
+		serialGLCD_drawLine(pixelX - 1, fromPixelY, pixelX, toPixelY, 1);
+	} else {
+		serialGLCD_drawLine(pixelX, toPixelY, pixelX, toPixelY, 1);
+	}
+}
+
+/** ##Plot - initialization
+ * 
+ * Consider UART was initialized and enabled.
+ *
+ * Ring buffer is emptied and the plot area is erased.
+ * @param plot Plot widget to be initialized
+ * @param left, top Pixel coordinates of the upper left corner of the plot area
+ * @param width Plot width in pixels, limited to PLOT_BUFFER_SIZE and to the right edge of the display
+ * @param height Plot height in pixels, limited to the bottom edge of the display
+ * @param minY, maxY Sample values shown at the bottom and at the top edge of the plot area
+ *
+ */
+void glcdPlot_init(PlotWidget *plot, unsigned char left, unsigned char top, unsigned char width, unsigned char height, int minY, int maxY)
+{
+	unsigned char column;
+	
+	// check the range
+	if (left > INITIAL_pixel_MAXX) left = 0;
+	if (top > INITIAL_pixel_MAXY) top = 0;
+	if (width > PLOT_BUFFER_SIZE) width = PLOT_BUFFER_SIZE;
+	if (width > INITIAL_pixel_MAXX - left + 1) width = INITIAL_pixel_MAXX - left + 1;
+	if (height > INITIAL_pixel_MAXY - top + 1) height = INITIAL_pixel_MAXY - top + 1;
+	if (height < 2) height = 2;
+	
+	plot->left = left;
+	plot->top = top;
+	plot->width = width;
+	plot->height = height;
+	plot->head = 0;
+	plot->count = 0;
+	plot->lastPixelY = top + height - 1;
+	glcdPlot_setScale(plot, minY, maxY);
+	
+	for (column = 0; column < width; column++)
+	{
+		glcdPlot_eraseColumn(plot, column);
+	}
+}
+
+/** ##Plot - set Y scaling
+ * 
+ * Only stores the new range. Call glcdPlot_redraw() to show stored samples with the new scaling.
+ * @param minY, maxY Sample values shown at the bottom and at the top edge of the plot area. If equal, the range is widened by one (minY is lowered if maxY is INT_MAX).
+ *
+ */
+void glcdPlot_setScale(PlotWidget *plot, int minY, int maxY)
+{
+	if (maxY < minY)
+	{
+		int swap = maxY;
+		maxY = minY;
+		minY = swap;
+	}
+	if (maxY == minY)
+	{
+		if (maxY < INT_MAX) maxY++;
+		else minY--;
+	}
+	plot->minY = minY;
+	plot->maxY = maxY;
+}
+
+/** ##Plot - add a new sample and update the screen incrementally
+ * 
+ * Consider UART was initialized and enabled.
+ *
+ * - sample is stored in the ring buffer at the cursor column
+ * - the column ahead of the cursor is erased (sweep gap, wraps to the first column at the right edge)
+ * - line segment from the previous sample to the new one is drawn
+ *
+ */
+void glcdPlot_addSample(PlotWidget *plot, int sample)
+{
+	unsigned char column = plot->head;
+	unsigned char ahead = column + 1;
+	unsigned char pixelY = glcdPlot_scale(plot, sample);
+	
+	if (ahead >= plot->width) ahead = 0;
+	
+	plot->samples[column] = sample;
+	if (plot->count < plot->width) plot->count++;
+	
+	glcdPlot_eraseColumn(plot, ahead);
+	glcdPlot_drawSegment(plot, column, plot->lastPixelY, pixelY);
+	
+	plot->lastPixelY = pixelY;
+	plot->head = ahead;
+}
+
+/** ##Plot - redraw whole plot from the ring buffer
+ * 
+ * Consider UART was initialized and enabled.
+ *
+ * To be used when the screen was cleared (e.g. re-entering the plot screen) or when the Y scaling was changed.
+ * Costs 2 line commands per stored sample, thus not intended to be called per sample.
+ *
+ */
+void glcdPlot_redraw(PlotWidget *plot)
+{
+	unsigned char column;
+	unsigned char pixelY;
+	unsigned char lastPixelY = plot->top + plot->height - 1;
+	
+	for (column = 0; column < plot->width; column++)
+	{
+		glcdPlot_eraseColumn(plot, column);
+		if ((column == plot->head) || (column >= plot->count)) continue;	// sweep gap or no data yet
+		pixelY = glcdPlot_scale(plot, plot->samples[column]);
+		if (column == plot->head + 1)
+		{
+			// oldest sample just after the sweep gap has no predecessor on the screen
+			serialGLCD_drawLine(plot->left + column, pixelY, plot->left + column, pixelY, 1);
+		} else {
+			glcdPlot_drawSegment(plot, column, lastPixelY, pixelY);
+		}
+		lastPixelY = pixelY;
+	}
+	if (plot->count)
+	{
+		column = plot->head ? plot->head - 1 : plot->width - 1;
+		plot->lastPixelY = glcdPlot_scale(plot, plot->samples[column]);
+	}
+}
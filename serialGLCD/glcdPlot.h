@@ -0,0 +1,45 @@
+﻿/*
+ * glcdPlot.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef GLCDPLOT_H_
+#define GLCDPLOT_H_
+
+#include "serialGLCD.h"
+
+/** 
+ * Size of the samples ring buffer. Defines the max plot width in pixels (columns).
+ * Each sample takes 2 bytes of SRAM.
+ */
+#define PLOT_BUFFER_SIZE	64
+
+/**
+ * A structure to represent a streaming time-series plot (sweep mode)
+ */
+typedef struct PlotStructure {
+	/*@{*/
+	unsigned char left;				/**< pixel X of the left edge of the plot area */
+	unsigned char top;				/**< pixel Y of the top edge of the plot area */
+	unsigned char width;			/**< plot width in pixels, one sample per column, up to PLOT_BUFFER_SIZE */
+	unsigned char height;			/**< plot height in pixels */
+	/*@}*/
+	/*@{*/
+	int minY;						/**< sample value shown at the bottom edge of the plot */
+	int maxY;						/**< sample value shown at the top edge of the plot */
+	/*@}*/
+	/*@{*/
+	int samples[PLOT_BUFFER_SIZE];	/**< ring buffer with the last 'width' samples */
+	unsigned char head;				/**< column (ring index) where the next sample is stored */
+	unsigned char count;			/**< number of valid samples in the ring buffer */
+	unsigned char lastPixelY;		/**< pixel Y of the last drawn sample, start point of the next line segment */
+	/*@}*/
+}PlotWidget;
+
+void glcdPlot_init(PlotWidget *plot, unsigned char left, unsigned char top, unsigned char width, unsigned char height, int minY, int maxY);
+void glcdPlot_setScale(PlotWidget *plot, int minY, int maxY);
+void glcdPlot_addSample(PlotWidget *plot, int sample);
+void glcdPlot_redraw(PlotWidget *plot);
+
+#endif /* GLCDPLOT_H_ */
@@ -0,0 +1,108 @@
+﻿/** \page pageScreen Screen Layouts
+ *
+ * ##Declarative handler screens, static texts plus fields bound to variables
+ *
+ * glcdScreen.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - A screen is described by a ScreenLayout, arrays of static texts and of dynamic fields (see glcdScreen.h)
+ * - glcdScreen_show() on entry draws the static texts and all fields
+ * - glcdScreen_update() afterwards compares each bound variable with the value of its last redraw,
+ *   only changed fields are sent (a goto and 'width' characters), the static texts never again
+ * - Thus a status screen with several live values costs a few bytes per changed value instead of a full redraw
+ *
+ * Example:
+ *
+ *		static const ScreenText texts[] = { {0, 0, "Count (0 - 100)"} };
+ *		static ScreenField fields[] = { {0, 1, 3, SCREEN_UCHAR, &myCounter} };
+ *		static const ScreenLayout screen = { texts, SCREEN_COUNT(texts), fields, SCREEN_COUNT(fields) };
+ *
+ */
+
+#include <stdio.h>
+#include "main.h"
+#include "serialGLCD.h"
+#include "glcdScreen.h"
+
+/** ##Screen - current value of the bound variable
+ */
+static unsigned long glcdScreen_value(const ScreenField *field)
+{
+	switch (field->type)
+	{
+		case SCREEN_UCHAR:	return *(const unsigned char *)field->value;
+		case SCREEN_INT:	return (unsigned long)(long)*(const int *)field->value;
+		case SCREEN_UINT:	return *(const unsigned int *)field->value;
+		case SCREEN_ULONG:	return *(const unsigned long *)field->value;
+		default:			return (unsigned long)(size_t)*(const char * const *)field->value;
+	}
+}
+
+/** ##Screen - redraw one field
+ *
+ * Value is written from the field origin, clipped to the field width and the rest of the width is padded with spaces.
+ * @param field Field to be drawn
+ * @param value Value of the bound variable, glcdScreen_value()
+ *
+ */
+static void glcdScreen_draw(ScreenField *field, unsigned long value)
+{
+	char number[12];				// "-2147483648"
+	const char *text = number;
+	unsigned char cell;
+
+	if (field->type == SCREEN_TEXT) text = (const char *)(size_t)value;
+	else if (field->type == SCREEN_INT) sprintf(number, "%ld", (long)value);
+	else sprintf(number, "%lu", value);
+	if (!text) text = "";
+
+	serialGLCD_goto21x8_XY(field->x, field->y);
+	for (cell = 0; (cell < field->width) && *text; cell++) serialGLCD_sendChar(*text++);
+	for (; cell < field->width; cell++) serialGLCD_sendChar(' ');
+	field->shown = value;
+}
+
+/** ##Screen - draw the whole screen
+ *
+ * Consider UART was initialized and enabled and the screen is clear (or the layout covers the previous content).
+ * @param screen Layout to be drawn, static texts first, then all fields with the current values
+ *
+ */
+void glcdScreen_show(const ScreenLayout *screen)
+{
+	unsigned char i;
+
+	for (i = 0; i < screen->textCount; i++)
+	{
+		serialGLCD_goto21x8_XY(screen->texts[i].x, screen->texts[i].y);
+		serialGLCD_sendString((char *)screen->texts[i].text);
+	}
+	for (i = 0; i < screen->fieldCount; i++)
+	{
+		glcdScreen_draw(&screen->fields[i], glcdScreen_value(&screen->fields[i]));
+	}
+}
+
+/** ##Screen - redraw the changed fields
+ *
+ * To be called after glcdScreen_show(), e.g. on each pass of the handler loop. Nothing is sent if no value changed.
+ * @param screen Layout shown
+ * @return number of fields redrawn, 0 if none
+ *
+ */
+unsigned char glcdScreen_update(const ScreenLayout *screen)
+{
+	unsigned char i;
+	unsigned char redrawn = 0;
+	unsigned long value;
+
+	for (i = 0; i < screen->fieldCount; i++)
+	{
+		value = glcdScreen_value(&screen->fields[i]);
+		if (value == screen->fields[i].shown) continue;
+		glcdScreen_draw(&screen->fields[i], value);
+		redrawn++;
+	}
+	return redrawn;
+}
\ No newline at end of file
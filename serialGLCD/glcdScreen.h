@@ -0,0 +1,60 @@
+﻿/*
+ * glcdScreen.h
+ *
+ * \author Simeon Neykov
+ */
+
+#ifndef GLCDSCREEN_H_
+#define GLCDSCREEN_H_
+
+#include "serialGLCD.h"
+
+/*@{*/
+#define SCREEN_UCHAR		0				///< field bound to an unsigned char, decimal
+#define SCREEN_INT			1				///< field bound to an int, decimal
+#define SCREEN_UINT			2				///< field bound to an unsigned int, decimal
+#define SCREEN_ULONG		3				///< field bound to an unsigned long, decimal
+#define SCREEN_TEXT			4				///< field bound to a const char pointer, redrawn when the pointer changes (e.g. "ON" / "OFF")
+/*@}*/
+
+#define SCREEN_COUNT(array)	(sizeof(array) / sizeof((array)[0]))	///< number of static texts or fields of a layout
+
+/**
+ * Static text of a screen, drawn once by glcdScreen_show()
+ */
+typedef struct ScreenTextStructure {
+	unsigned char x;				/**< column, character format */
+	unsigned char y;				/**< row, character format */
+	const char *text;				/**< text */
+}ScreenText;
+
+/**
+ * Dynamic field of a screen, drawn by glcdScreen_update() when the bound variable changes
+ */
+typedef struct ScreenFieldStructure {
+	/*@{*/
+	unsigned char x;				/**< column, character format */
+	unsigned char y;				/**< row, character format */
+	unsigned char width;			/**< cells owned by the field, the value is clipped and padded with spaces to it */
+	unsigned char type;				/**< SCREEN_UCHAR, SCREEN_INT, ... */
+	const void *value;				/**< bound variable */
+	/*@}*/
+	unsigned long shown;			/**< value (or text pointer) of the last redraw */
+}ScreenField;
+
+/**
+ * A structure to represent a screen layout, static texts plus dynamic fields
+ */
+typedef struct ScreenStructure {
+	/*@{*/
+	const ScreenText *texts;		/**< static texts */
+	unsigned char textCount;		/**< number of static texts */
+	ScreenField *fields;			/**< dynamic fields */
+	unsigned char fieldCount;		/**< number of dynamic fields */
+	/*@}*/
+}ScreenLayout;
+
+void glcdScreen_show(const ScreenLayout *screen);
+unsigned char glcdScreen_update(const ScreenLayout *screen);
+
+#endif /* GLCDSCREEN_H_ */
\ No newline at end of file
@@ -0,0 +1,147 @@
+﻿/** \page pageText Text Layout Widget
+ *
+ * ##Word wrapped multi-line text on the serial GLCD, shown page by page
+ *
+ * glcdText.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Text is placed in a rectangular region of the character format (21x8, 26x16), independently of the backpack's own edge wrap
+ * - Lines are broken at spaces, a word longer than the region width is broken at the region edge, '\n' forces a break
+ * - Line breaks are found once in glcdText_init() and cached in the widget, a redraw does not scan the text again
+ * - Widget keeps the number of characters written at each row, a redraw pads with spaces only the cells
+ *   left over from the previous content of that row (the whole region on the first redraw, content unknown)
+ * - Text longer than the region is shown page by page, each page is one redraw (e.g. encoder steps through the pages)
+ *
+ */
+
+#include "main.h"
+#include "serialGLCD.h"
+#include "glcdText.h"
+
+/** ##Text - find the line breaks
+ *
+ * @param widget Widget with the region and the text set, the cache is filled in
+ *
+ */
+static void glcdText_layout(TextWidget *widget)
+{
+	const char *text = widget->text;
+	unsigned int pos = 0;
+	unsigned int i;
+	unsigned int space;
+	unsigned int next;
+	unsigned char length;
+
+	widget->lines = 0;
+	while (text[pos] && (widget->lines < TEXT_MAX_LINES))
+	{
+		// longest part fitting in the region, remember the last space in it
+		space = 0;
+		for (i = pos; text[i] && (text[i] != '\n') && (i - pos < widget->cols); i++)
+		{
+			if ((text[i] == ' ') && (i > pos)) space = i;
+		}
+		if ((text[i] == 0) || (text[i] == '\n') || (text[i] == ' '))
+		{
+			// the whole part fits, break at the end
+			length = i - pos;
+			next = (text[i] == 0) ? i : i + 1;
+		} else if (space) {
+			// break at the last space
+			length = space - pos;
+			next = space + 1;
+		} else {
+			// a word longer than the region, break at the region edge
+			length = i - pos;
+			next = i;
+		}
+		while (length && (text[pos + length - 1] == ' ')) length--;
+
+		widget->start[widget->lines] = pos;
+		widget->length[widget->lines] = length;
+		widget->lines++;
+
+		// spaces at the beginning of a wrapped line are dropped, the ones after '\n' kept (indentation)
+		if ((next > 0) && (text[next - 1] != '\n'))
+		{
+			while (text[next] == ' ') next++;
+		}
+		pos = next;
+	}
+}
+
+/** ##Text - initialization
+ *
+ * Word wraps the text, nothing is sent. Consider the text is constant while the widget is used.
+ * @param widget Widget to be initialized
+ * @param left, top Upper left corner of the region, character format indexed from 0, 0
+ * @param cols, rows Region size in characters, limited to fit on the display
+ * @param text Text to be shown
+ *
+ */
+void glcdText_init(TextWidget *widget, unsigned char left, unsigned char top, unsigned char cols, unsigned char rows, const char *text)
+{
+	unsigned char row;
+
+	// check the range
+	if (left > TEXT_MAX_COLS - 1) left = 0;
+	if (top > TEXT_MAX_ROWS - 1) top = 0;
+	if (cols > TEXT_MAX_COLS - left) cols = TEXT_MAX_COLS - left;
+	if (rows > TEXT_MAX_ROWS - top) rows = TEXT_MAX_ROWS - top;
+	if (cols == 0) cols = 1;
+	if (rows == 0) rows = 1;
+
+	widget->left = left;
+	widget->top = top;
+	widget->cols = cols;
+	widget->rows = rows;
+	widget->text = text;
+	widget->page = 0;
+	for (row = 0; row < rows; row++) widget->shown[row] = cols;
+	glcdText_layout(widget);
+}
+
+/** ##Text - number of pages
+ *
+ * @return number of pages of the wrapped text, at least 1
+ *
+ */
+unsigned char glcdText_pages(TextWidget *widget)
+{
+	if (widget->lines == 0) return 1;
+	return (widget->lines + widget->rows - 1) / widget->rows;
+}
+
+/** ##Text - show a page
+ *
+ * Consider UART was initialized and enabled.
+ *
+ * Each row sends a goto, the line from the cache and spaces over what is left of the previous content.
+ * Rows empty before and after are not sent at all.
+ * @param widget Initialized widget
+ * @param page Page to be shown, limited to the last page
+ *
+ */
+void glcdText_show(TextWidget *widget, unsigned char page)
+{
+	unsigned char row;
+	unsigned char line;
+	unsigned char length;
+	unsigned char cell;
+
+	if (page > glcdText_pages(widget) - 1) page = glcdText_pages(widget) - 1;
+	widget->page = page;
+
+	for (row = 0; row < widget->rows; row++)
+	{
+		line = page * widget->rows + row;
+		length = (line < widget->lines) ? widget->length[line] : 0;
+		if ((length == 0) && (widget->shown[row] == 0)) continue;
+
+		serialGLCD_goto21x8_XY(widget->left, widget->top + row);
+		for (cell = 0; cell < length; cell++) serialGLCD_sendChar(widget->text[widget->start[line] + cell]);
+		for (; cell < widget->shown[row]; cell++) serialGLCD_sendChar(' ');
+		widget->shown[row] = length;
+	}
+}
\ No newline at end of file
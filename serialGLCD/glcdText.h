@@ -0,0 +1,46 @@
+﻿/*
+ * glcdText.h
+ *
+ * \author Simeon Neykov
+ */
+
+#ifndef GLCDTEXT_H_
+#define GLCDTEXT_H_
+
+#include "serialGLCD.h"
+
+/**
+ * Size of the line breaks cache. Defines the max number of wrapped lines of one text, the rest is not shown.
+ * Each line takes 3 bytes of SRAM.
+ */
+#define TEXT_MAX_LINES		24
+#define TEXT_MAX_COLS		GLCD_COLS		///< max region width in characters
+#define TEXT_MAX_ROWS		GLCD_ROWS		///< max region height in characters
+
+/**
+ * A structure to represent a word wrapped text in a rectangular character region, shown page by page
+ */
+typedef struct TextStructure {
+	/*@{*/
+	unsigned char left;						/**< column of the upper left corner of the region, character format */
+	unsigned char top;						/**< row of the upper left corner of the region, character format */
+	unsigned char cols;						/**< region width in characters */
+	unsigned char rows;						/**< region height in characters, one page */
+	/*@}*/
+	/*@{*/
+	const char *text;						/**< text to be shown, '\n' forces a line break */
+	unsigned int start[TEXT_MAX_LINES];		/**< line breaks cache - offset of the first character of each line */
+	unsigned char length[TEXT_MAX_LINES];	/**< line breaks cache - number of characters of each line, trailing spaces dropped */
+	unsigned char lines;					/**< number of wrapped lines */
+	/*@}*/
+	/*@{*/
+	unsigned char page;						/**< page shown, 0 .. glcdText_pages() - 1 */
+	unsigned char shown[TEXT_MAX_ROWS];		/**< characters written at each row of the region by the last redraw */
+	/*@}*/
+}TextWidget;
+
+void glcdText_init(TextWidget *widget, unsigned char left, unsigned char top, unsigned char cols, unsigned char rows, const char *text);
+unsigned char glcdText_pages(TextWidget *widget);
+void glcdText_show(TextWidget *widget, unsigned char page);
+
+#endif /* GLCDTEXT_H_ */
\ No newline at end of file
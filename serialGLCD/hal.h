@@ -0,0 +1,52 @@
+﻿/*
+ * hal.h
+ *
+ * \author Simeon Neykov
+ *
+ * Register level hardware abstraction: the MCU registers with a side effect on read or write
+ * (UART0 transmitter, port inputs, Timer1 count) are accessed only through these macros.
+ * - AVR: the macros are the register accesses themselves, no cost
+ * - HAL_HOST (native Linux build, see host/): the macros call functions of the simulated devices,
+ *   the other registers (DDRx, PORTx, control registers) are plain variables of the host avr/io.h
+ */
+
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <avr/io.h>
+
+#ifndef HAL_HOST
+
+/*@{*/
+#define HAL_UART0_READY()			(UCSR0A & (1 << UDRE0))		///< non zero if UART0 accepts the next byte
+#define HAL_UART0_WRITE(data)		(UDR0 = (data))				///< load the UART0 transmit buffer
+#define HAL_PINB()					(PINB)						///< port B input levels
+#define HAL_PINC()					(PINC)						///< port C input levels (buttons, rotary encoder)
+#define HAL_PIND()					(PIND)						///< port D input levels
+#define HAL_TIMER1_COUNT()			(TCNT1)						///< Timer1 count
+#define HAL_TIMER1_OVERFLOW()		(TIFR1 & (1 << TOV1))		///< non zero if the Timer1 overflow is pending
+/*@}*/
+
+#else
+
+unsigned char hal_uart0Ready(void);
+void hal_uart0Write(unsigned char data);
+unsigned char hal_pinB(void);
+unsigned char hal_pinC(void);
+unsigned char hal_pinD(void);
+unsigned int hal_timer1Count(void);
+unsigned char hal_timer1Overflow(void);
+
+/*@{*/
+#define HAL_UART0_READY()			hal_uart0Ready()
+#define HAL_UART0_WRITE(data)		hal_uart0Write(data)
+#define HAL_PINB()					hal_pinB()					///< key matrix columns
+#define HAL_PINC()					hal_pinC()
+#define HAL_PIND()					hal_pinD()					///< key matrix columns
+#define HAL_TIMER1_COUNT()			hal_timer1Count()
+#define HAL_TIMER1_OVERFLOW()		hal_timer1Overflow()
+/*@}*/
+
+#endif
+
+#endif /* HAL_H_ */
@@ -0,0 +1,196 @@
+﻿/** \page pageHD44780 HD44780 Character LCD
+ * 
+ * ##Utilize HD44780 based character LCD as a menu display backend
+ *
+ * hd44780.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Used with DISPLAY_16x4, DISPLAY_20x4, DISPLAY_16x2 and DISPLAY_20x2 display types defined in charMenu.h
+ * - Parallel 4-bit interface, R/W line connected, thus busy flag is polled instead of fixed worst-case delays:
+ *		- a command or a character takes ~40us instead of the worst-case delay
+ *		- clear takes ~1.5ms, polling returns as soon as the controller is ready
+ * - Fixed delays are used only in the initialization sequence, before the busy flag is valid
+ * - A whole menu row is sent with a single set DDRAM address command, the address is incremented by the controller afterwards
+ * - Replayed on the host against a model of the controller (host/hostsim.c, ./replay1602 and ./replay2004): the DDRAM
+ *   content, the bus writes per input event and the writes while busy are compared to baselines
+ *
+ */
+
+#include <avr/io.h>
+#include "main.h"
+#include "ports_and_pins.h"
+#include "charMenu.h"
+#include "hd44780.h"
+#include <util/delay.h>
+#include <string.h>
+
+#define LCD_DATA_MASK	(0x0F << lcdData_shift)		///< D4..D7 pins mask in the data port
+
+MenuDisplay hd44780_menuDisplay = { hd44780_clear, hd44780_writeMenuString, 0 };	///< HD44780 backend of the menu handler
+
+/**
+ * DDRAM address of the first character of each row.
+ * START_ROW3 and START_ROW4 give the addresses of the rows which differ between the display types.
+ */
+#if defined(START_ROW3) && (DISPLAY_ROWS == 4)
+static const unsigned char hd44780_rowStart[4] = {0x00, 0x40, START_ROW3, START_ROW4};
+#elif defined(START_ROW3)
+static const unsigned char hd44780_rowStart[2] = {START_ROW3, START_ROW4};
+#else
+static const unsigned char hd44780_rowStart[4] = {0x00, 0x40, 0x14, 0x54};
+#endif
+
+#define LCD_ROWS	(sizeof(hd44780_rowStart))
+
+/** ##HD44780 - enable pulse
+ * Data is latched on the falling edge of E. Pulse width min 450ns.
+ */
+static void hd44780_pulseE(void)
+{
+	PIN_HIGH(PIN_LCD_E);
+	_delay_us(1);
+	PIN_LOW(PIN_LCD_E);
+}
+
+/** ##HD44780 - write 4 bits to D4..D7
+ */
+static void hd44780_writeNibble(unsigned char nibble)
+{
+	lcdData_dataPort = (lcdData_dataPort & ~LCD_DATA_MASK) | ((nibble & 0x0F) << lcdData_shift);
+	hd44780_pulseE();
+}
+
+/** ##HD44780 - read the status byte (busy flag and address counter)
+ *
+ * - D4..D7 are switched to inputs (pull-ups off) for the read, back to outputs afterwards
+ * - 4-bit interface gives upper nibble first, lower nibble on the second E pulse
+ */
+static unsigned char hd44780_readStatus(void)
+{
+	unsigned char status;
+	
+	lcdData_dirPort &= ~LCD_DATA_MASK;
+	lcdData_dataPort &= ~LCD_DATA_MASK;
+	PIN_LOW(PIN_LCD_RS);
+	PIN_HIGH(PIN_LCD_RW);
+	
+	PIN_HIGH(PIN_LCD_E);
+	_delay_us(1);
+	status = ((lcdData_pinPort & LCD_DATA_MASK) >> lcdData_shift) << 4;
+	PIN_LOW(PIN_LCD_E);
+	_delay_us(1);
+	PIN_HIGH(PIN_LCD_E);
+	_delay_us(1);
+	status |= (lcdData_pinPort & LCD_DATA_MASK) >> lcdData_shift;
+	PIN_LOW(PIN_LCD_E);
+	
+	PIN_LOW(PIN_LCD_RW);
+	lcdData_dirPort |= LCD_DATA_MASK;
+	return status;
+}
+
+/** ##HD44780 - wait while the controller is busy
+ *
+ * Polls the busy flag. HD44780_BUSY_TIMEOUT limits the polling if the display is not connected.
+ */
+static void hd44780_waitBusy(void)
+{
+	unsigned int timeout = HD44780_BUSY_TIMEOUT;
+	
+	while ((hd44780_readStatus() & HD44780_BUSY_FLAG) && timeout) timeout--;
+}
+
+/** ##HD44780 - write a byte
+ * @param data Command or character code
+ * @param rs 0 for a command, 1 for a character (DDRAM data)
+ */
+static void hd44780_writeByte(unsigned char data, unsigned char rs)
+{
+	hd44780_waitBusy();
+	if (rs) PIN_HIGH(PIN_LCD_RS); else PIN_LOW(PIN_LCD_RS);
+	hd44780_writeNibble(data >> 4);
+	hd44780_writeNibble(data);
+}
+
+/** ##HD44780 - initialization by instruction, 4-bit interface
+ * 
+ * - E, RS, R/W and D4..D7 as outputs
+ * - Busy flag can't be checked before the interface is set to 4-bit mode, thus datasheet's fixed delays are used here:
+ *		- wait >40ms after power on
+ *		- 3 times function set 8-bit (0x3), then set 4-bit (0x2)
+ * - Function set, display off, clear, entry mode, display on. From here on the busy flag is used.
+ *
+ */
+void hd44780_init(void)
+{
+	PIN_OUTPUT(PIN_LCD_RS);
+	PIN_OUTPUT(PIN_LCD_RW);
+	PIN_OUTPUT(PIN_LCD_E);
+	PIN_LOW(PIN_LCD_RS);
+	PIN_LOW(PIN_LCD_RW);
+	PIN_LOW(PIN_LCD_E);
+	lcdData_dirPort |= LCD_DATA_MASK;
+	
+	_delay_ms(50);
+	hd44780_writeNibble(0x03);
+	_delay_ms(5);
+	hd44780_writeNibble(0x03);
+	_delay_us(150);
+	hd44780_writeNibble(0x03);
+	_delay_us(150);
+	hd44780_writeNibble(0x02);
+	_delay_us(150);
+	
+	hd44780_writeByte(HD44780_FUNCTION_SET, 0);
+	hd44780_writeByte(HD44780_DISPLAY_OFF, 0);
+	hd44780_writeByte(HD44780_CLEAR, 0);
+	hd44780_writeByte(HD44780_ENTRY_MODE, 0);
+	hd44780_writeByte(HD44780_DISPLAY_ON, 0);
+}
+
+/** ##HD44780 - clear the display
+ * The controller is busy ~1.5ms afterwards, next write waits for the busy flag.
+ */
+void hd44780_clear(void)
+{
+	hd44780_writeByte(HD44780_CLEAR, 0);
+}
+
+/** ##Menu Handler - send LCD menu string at reference location, HD44780 backend
+ * 
+ * Same behavior as serialGLCD_writeMenuString() for a character LCD.
+ * The DDRAM address is set once per row, then characters follow with auto increment.
+ *
+ * @param refX, refY reference coordinates as for character LCD format (e.g. 20 x 4) indexed from 0, 0.
+ * @param *lcd_menu_items a pointer to the characters in selected menu item to be displayed on the LCD screen
+ * @param add_line if 1 (or just > 1) then complete the row with character given in add_char. If add_line =0 the row would not be completed till the end.
+ * @param add_char character to be used to complete the row after the menu string if add_line >=1.
+ *
+ */
+void hd44780_writeMenuString(unsigned char refX, unsigned char refY, const char *lcd_menu_items, unsigned char add_line, char add_char)
+{
+	unsigned char lcd_i;
+	unsigned char lcd_offset = 0;
+	
+	// check the range
+	if (refX >= INITIAL_MAXX) refX = 0;
+	if (refY >= LCD_ROWS) refY = 0;
+	
+	hd44780_writeByte(HD44780_SET_DDRAM | (hd44780_rowStart[refY] + refX), 0);
+	
+	lcd_offset = strlen(lcd_menu_items);
+	
+	if (lcd_offset > INITIAL_MAXX - refX) lcd_offset = INITIAL_MAXX - refX;
+	for (lcd_i = lcd_offset; lcd_i; lcd_i--)
+	{
+		hd44780_writeByte(*lcd_menu_items++, 1);
+	}
+	if (add_line)
+	{
+		for (lcd_i = INITIAL_MAXX - lcd_offset - refX; lcd_i; lcd_i--) 
+		{
+			hd44780_writeByte(add_char, 1);
+		}
+	}
+}
@@ -0,0 +1,29 @@
+﻿/*
+ * hd44780.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef HD44780_H_
+#define HD44780_H_
+
+#include "charMenu.h"
+
+/*@{*/
+#define HD44780_CLEAR			0x01			///< clear display, cursor home
+#define HD44780_ENTRY_MODE		0x06			///< increment address, no display shift
+#define HD44780_DISPLAY_ON		0x0C			///< display on, cursor off, blink off
+#define HD44780_DISPLAY_OFF		0x08			///< display off, cursor off, blink off
+#define HD44780_FUNCTION_SET	0x28			///< 4-bit interface, 2 lines (also used for 4 rows displays), 5x8 font
+#define HD44780_SET_DDRAM		0x80			///< set DDRAM address command, address is in lower 7 bits
+#define HD44780_BUSY_FLAG		0x80			///< busy flag in the status byte
+#define HD44780_BUSY_TIMEOUT	2000			///< max status reads while waiting for busy flag, keeps the MCU running if no display is connected
+/*@}*/
+
+extern MenuDisplay hd44780_menuDisplay;
+
+void hd44780_init(void);
+void hd44780_clear(void);
+void hd44780_writeMenuString(unsigned char refX, unsigned char refY, const char *lcd_menu_items, unsigned char add_line, char add_char);
+
+#endif /* HD44780_H_ */
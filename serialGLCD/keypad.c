@@ -0,0 +1,283 @@
+﻿/** \page pageKeypad Key matrix
+ *
+ * ##Key matrix scanner in the 1ms timer interrupt, debounce, n-key rollover and ghost detection
+ *
+ * keypad.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Rows and columns are pin descriptors (PIN_KEYPAD_ROW0 .., PIN_KEYPAD_COL0 .. in main.h), any port, up to 8 x 8
+ * - One row per Timer0 tick (1ms, called from the interrupt of repeat.c): the columns of the row driven since the
+ *   previous tick are read, the row is released (high impedance, never driven high, thus two keys on one column
+ *   do not short two rows) and the next row is driven low. The row settles for a whole tick before it is read.
+ * - The work per tick is bounded: one row read and debounced, once per matrix scan (every KEYPAD_ROWS ticks)
+ *   the ghost check and the events. Its duration is measured with Timer1, see keypad_scanSum etc.
+ * - Debounce: 2-bit vertical counters, one bit per key in 3 bytes per row. A key changes its state after
+ *   4 equal samples in a row, thus 4 * KEYPAD_ROWS ms (16ms for 4 rows).
+ * - n-key rollover: every key has its own state, any number of keys could be held
+ * - Ghost detection: without diodes, three keys in the corners of a rectangle connect the fourth corner as well.
+ *   A matrix where two rows share two pressed columns is ambiguous: no press is reported until it is resolved,
+ *   releases are reported. keypad_ghosts counts these situations.
+ * - Events (key code, KEYPAD_RELEASED for a release) are queued, the main loop takes them with keypad_take()
+ *   and gives them to the menu (see main.c)
+ *
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "main.h"
+#include "charMenu.h"
+#include "ports_and_pins.h"
+#include "keypad.h"
+
+#if (KEYPAD_ENABLE == TRUE) && !defined(DISPLAY_GLCD)
+#error "keypad rows are on the HD44780 data pins, set KEYPAD_ENABLE FALSE or move the rows"
+#endif
+#if (KEYPAD_ROWS > 8) || (KEYPAD_COLS > 8)
+#error "keypad is at most 8 x 8"
+#endif
+
+volatile unsigned int keypad_ghosts = 0;		///< ambiguous key combinations seen, presses were held back
+volatile unsigned int keypad_lost = 0;			///< events dropped because the queue was full
+volatile unsigned long keypad_scanSum = 0;		///< sum of the scan durations in Timer1 ticks, keypad_scanSum / keypad_scanCount is the mean
+volatile unsigned int keypad_scanCount = 0;		///< scans measured, the sum and the count restart when the count wraps
+volatile unsigned char keypad_scanMax = 0;		///< longest scan in Timer1 ticks
+
+static unsigned char keypad_row = 0;					///< row driven now
+static unsigned char keypad_state[KEYPAD_ROWS];			///< debounced state, bit per column, 1 pressed
+static unsigned char keypad_count0[KEYPAD_ROWS];		///< vertical counter, low bits
+static unsigned char keypad_count1[KEYPAD_ROWS];		///< vertical counter, high bits
+static unsigned char keypad_reported[KEYPAD_ROWS];		///< keys reported pressed
+static unsigned char keypad_ghost = 0;					///< matrix ambiguous in the last scan
+static unsigned char keypad_queue[KEYPAD_QUEUE];		///< events not taken yet
+static volatile unsigned char keypad_head = 0;
+static volatile unsigned char keypad_tail = 0;
+
+/** ##Key matrix - drive a row low or release it to high impedance
+ *
+ * The port bit stays LOW, only the direction changes.
+ */
+static void keypad_drive(unsigned char row, unsigned char drive)
+{
+	switch (row)
+	{
+		case 0: if (drive) PIN_OUTPUT(PIN_KEYPAD_ROW0); else PIN_INPUT(PIN_KEYPAD_ROW0); break;
+#if (KEYPAD_ROWS > 1)
+		case 1: if (drive) PIN_OUTPUT(PIN_KEYPAD_ROW1); else PIN_INPUT(PIN_KEYPAD_ROW1); break;
+#endif
+#if (KEYPAD_ROWS > 2)
+		case 2: if (drive) PIN_OUTPUT(PIN_KEYPAD_ROW2); else PIN_INPUT(PIN_KEYPAD_ROW2); break;
+#endif
+#if (KEYPAD_ROWS > 3)
+		case 3: if (drive) PIN_OUTPUT(PIN_KEYPAD_ROW3); else PIN_INPUT(PIN_KEYPAD_ROW3); break;
+#endif
+#if (KEYPAD_ROWS > 4)
+		case 4: if (drive) PIN_OUTPUT(PIN_KEYPAD_ROW4); else PIN_INPUT(PIN_KEYPAD_ROW4); break;
+#endif
+#if (KEYPAD_ROWS > 5)
+		case 5: if (drive) PIN_OUTPUT(PIN_KEYPAD_ROW5); else PIN_INPUT(PIN_KEYPAD_ROW5); break;
+#endif
+#if (KEYPAD_ROWS > 6)
+		case 6: if (drive) PIN_OUTPUT(PIN_KEYPAD_ROW6); else PIN_INPUT(PIN_KEYPAD_ROW6); break;
+#endif
+#if (KEYPAD_ROWS > 7)
+		case 7: if (drive) PIN_OUTPUT(PIN_KEYPAD_ROW7); else PIN_INPUT(PIN_KEYPAD_ROW7); break;
+#endif
+	}
+}
+
+/** ##Key matrix - columns pulled low by the driven row, bit per column, 1 pressed
+ */
+static unsigned char keypad_columns(void)
+{
+	unsigned char columns = 0;
+
+	if (!PIN_LEVEL(PIN_KEYPAD_COL0)) columns |= 0x01;
+#if (KEYPAD_COLS > 1)
+	if (!PIN_LEVEL(PIN_KEYPAD_COL1)) columns |= 0x02;
+#endif
+#if (KEYPAD_COLS > 2)
+	if (!PIN_LEVEL(PIN_KEYPAD_COL2)) columns |= 0x04;
+#endif
+#if (KEYPAD_COLS > 3)
+	if (!PIN_LEVEL(PIN_KEYPAD_COL3)) columns |= 0x08;
+#endif
+#if (KEYPAD_COLS > 4)
+	if (!PIN_LEVEL(PIN_KEYPAD_COL4)) columns |= 0x10;
+#endif
+#if (KEYPAD_COLS > 5)
+	if (!PIN_LEVEL(PIN_KEYPAD_COL5)) columns |= 0x20;
+#endif
+#if (KEYPAD_COLS > 6)
+	if (!PIN_LEVEL(PIN_KEYPAD_COL6)) columns |= 0x40;
+#endif
+#if (KEYPAD_COLS > 7)
+	if (!PIN_LEVEL(PIN_KEYPAD_COL7)) columns |= 0x80;
+#endif
+	return columns;
+}
+
+/** ##Key matrix - queue an event, dropped and counted if the queue is full
+ */
+static void keypad_queueEvent(unsigned char event)
+{
+	unsigned char next = (keypad_head + 1) & (KEYPAD_QUEUE - 1);
+
+	if (next == keypad_tail)
+	{
+		keypad_lost++;
+		return;
+	}
+	keypad_queue[keypad_head] = event;
+	keypad_head = next;
+}
+
+/** ##Key matrix - a whole scan is debounced: ghost check and the events of the changed keys
+ */
+static void keypad_publish(void)
+{
+	unsigned char row;
+	unsigned char other;
+	unsigned char common;
+	unsigned char pressed;
+	unsigned char released;
+	unsigned char column;
+	unsigned char ghost = 0;
+
+	// two rows sharing two pressed columns: a rectangle of keys, one of them could be a ghost
+	for (row = 0; row < KEYPAD_ROWS; row++)
+	{
+		for (other = row + 1; other < KEYPAD_ROWS; other++)
+		{
+			common = keypad_state[row] & keypad_state[other];
+			if (common & (common - 1)) ghost = 1;
+		}
+	}
+	if (ghost && !keypad_ghost) keypad_ghosts++;
+	keypad_ghost = ghost;
+
+	for (row = 0; row < KEYPAD_ROWS; row++)
+	{
+		released = keypad_reported[row] & ~keypad_state[row];
+		pressed = ghost ? 0 : keypad_state[row] & ~keypad_reported[row];
+		if (!(released | pressed)) continue;
+		for (column = 0; column < KEYPAD_COLS; column++)
+		{
+			if (released & (1 << column)) keypad_queueEvent((row * KEYPAD_COLS + column) | KEYPAD_RELEASED);
+			if (pressed & (1 << column)) keypad_queueEvent(row * KEYPAD_COLS + column);
+		}
+		keypad_reported[row] = (keypad_reported[row] & ~released) | pressed;
+	}
+}
+
+/** ##Key matrix - initialization
+ *
+ * Rows released (high impedance, port bit LOW), columns as inputs with pull-up. The first row is driven.
+ * Consider repeat_init() starts the Timer0 interrupt calling keypad_scan().
+ *
+ */
+void keypad_init(void)
+{
+	unsigned char row;
+
+	for (row = 0; row < KEYPAD_ROWS; row++)
+	{
+		keypad_drive(row, 0);
+		keypad_state[row] = 0;
+		keypad_count0[row] = 0xFF;			// counters at rest
+		keypad_count1[row] = 0xFF;
+		keypad_reported[row] = 0;
+	}
+	PIN_LOW(PIN_KEYPAD_ROW0);
+#if (KEYPAD_ROWS > 1)
+	PIN_LOW(PIN_KEYPAD_ROW1);
+#endif
+#if (KEYPAD_ROWS > 2)
+	PIN_LOW(PIN_KEYPAD_ROW2);
+#endif
+#if (KEYPAD_ROWS > 3)
+	PIN_LOW(PIN_KEYPAD_ROW3);
+#endif
+#if (KEYPAD_ROWS > 4)
+	PIN_LOW(PIN_KEYPAD_ROW4);
+#endif
+#if (KEYPAD_ROWS > 5)
+	PIN_LOW(PIN_KEYPAD_ROW5);
+#endif
+#if (KEYPAD_ROWS > 6)
+	PIN_LOW(PIN_KEYPAD_ROW6);
+#endif
+#if (KEYPAD_ROWS > 7)
+	PIN_LOW(PIN_KEYPAD_ROW7);
+#endif
+	PIN_PULLUP(PIN_KEYPAD_COL0);
+#if (KEYPAD_COLS > 1)
+	PIN_PULLUP(PIN_KEYPAD_COL1);
+#endif
+#if (KEYPAD_COLS > 2)
+	PIN_PULLUP(PIN_KEYPAD_COL2);
+#endif
+#if (KEYPAD_COLS > 3)
+	PIN_PULLUP(PIN_KEYPAD_COL3);
+#endif
+#if (KEYPAD_COLS > 4)
+	PIN_PULLUP(PIN_KEYPAD_COL4);
+#endif
+#if (KEYPAD_COLS > 5)
+	PIN_PULLUP(PIN_KEYPAD_COL5);
+#endif
+#if (KEYPAD_COLS > 6)
+	PIN_PULLUP(PIN_KEYPAD_COL6);
+#endif
+#if (KEYPAD_COLS > 7)
+	PIN_PULLUP(PIN_KEYPAD_COL7);
+#endif
+	keypad_row = 0;
+	keypad_drive(0, 1);
+}
+
+/** ##Key matrix - one scan step, called every 1ms from the Timer0 interrupt
+ *
+ * Reads the row driven since the previous call, drives the next one. Vertical counter debounce of the row:
+ * a changed key counts 3, 2, 1, 0 (count1:count0) and toggles its state at the 4th equal sample, a key equal
+ * to its state keeps the counter at rest.
+ *
+ */
+void keypad_scan(void)
+{
+	unsigned int start = HAL_TIMER1_COUNT();
+	unsigned char row = keypad_row;
+	unsigned char change;
+	unsigned int ticks;
+
+	change = keypad_state[row] ^ keypad_columns();
+	keypad_drive(row, 0);
+	keypad_row = (row + 1 < KEYPAD_ROWS) ? row + 1 : 0;
+	keypad_drive(keypad_row, 1);
+
+	keypad_count0[row] = ~(keypad_count0[row] & change);
+	keypad_count1[row] = keypad_count0[row] ^ (keypad_count1[row] & change);
+	change &= keypad_count0[row] & keypad_count1[row];
+	keypad_state[row] ^= change;
+	if (keypad_row == 0) keypad_publish();
+
+	ticks = HAL_TIMER1_COUNT() - start;
+	if (++keypad_scanCount == 0) keypad_scanSum = 0;
+	keypad_scanSum += ticks;
+	if (ticks > keypad_scanMax) keypad_scanMax = (ticks > 255) ? 255 : ticks;
+}
+
+/** ##Key matrix - take the next key event
+ *
+ * @return key code (row * KEYPAD_COLS + column), with KEYPAD_RELEASED for a release. KEYPAD_NONE if there is no event.
+ *
+ */
+unsigned char keypad_take(void)
+{
+	unsigned char event;
+
+	if (keypad_tail == keypad_head) return KEYPAD_NONE;
+	event = keypad_queue[keypad_tail];
+	keypad_tail = (keypad_tail + 1) & (KEYPAD_QUEUE - 1);
+	return event;
+}
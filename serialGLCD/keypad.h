@@ -0,0 +1,29 @@
+﻿/*
+ * keypad.h
+ *
+ * \author Simeon Neykov
+ */
+
+#ifndef KEYPAD_H_
+#define KEYPAD_H_
+
+#include "main.h"
+
+/*@{*/
+#define KEYPAD_KEYS			(KEYPAD_ROWS * KEYPAD_COLS)	///< key codes 0 .. KEYPAD_KEYS - 1, row * KEYPAD_COLS + column
+#define KEYPAD_RELEASED		0x80						///< flag of a key event: the key was released (pressed if clear)
+#define KEYPAD_NONE			0xFF						///< keypad_take(): no event
+#define KEYPAD_KEY(event)	((event) & ~KEYPAD_RELEASED)	///< key code of an event
+/*@}*/
+
+extern volatile unsigned int keypad_ghosts;
+extern volatile unsigned int keypad_lost;
+extern volatile unsigned long keypad_scanSum;
+extern volatile unsigned int keypad_scanCount;
+extern volatile unsigned char keypad_scanMax;
+
+void keypad_init(void);
+void keypad_scan(void);
+unsigned char keypad_take(void);
+
+#endif /* KEYPAD_H_ */
@@ -1,331 +1,778 @@
-/** \mainpage Main
- * # Utilize serial backpack GLCD ADM12864H
- *
- * main.c
- *
- * \author	Simeon Neykov
- * 
- * [Used demos](https://www.avrfreaks.net/forum/tut-c-bit-manipulation-aka-programming-101?name=PNphpBB2&file=viewtopic&t=37871)
- *
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * ##Main function concept:
- * - Definitions and initializations
- *		- variables definition and initializations
- *		- I/O ports and pins definitions and initializations
- *		- USART (in this application UART mode used) initialization
- * - Infinite loop
- *		- show the menu
- *		- pooling the events (up, down, enter, etc)
- *		- browse the menu accordingly
- */ 
-
-#include "main.h"
-#include <avr/io.h>
-#include <util/delay.h>
-#include "serialGLCD.h"
-#include "USART.h"
-#include "charMenu.h"
-#include "ports_and_pins.h"
-#include <stdio.h>
-#include <string.h>
-
-extern unsigned char read_PINx_digital_level(unsigned char pinport, unsigned char pin);
-
-unsigned char update_menu = 1;
-unsigned char temp = 0;
-int rotary_delay = ROTARY_DELAY;
-unsigned char lastStateROTARY_CK = 0;
-unsigned char currentStateROTARY_CK = 0;
-unsigned char currentStateROTARY_DA = 0;
-
-/** \file
- * ##Main function
- *
- * - Declare and initialize needed software variables
- *		- buttonPressed_delay, buttonReleased_delay are used for push button debouncing	
- *		- update_menu controls menu to be updated only when changes are supposed (button pressed, etc)
- *		- initialize menu item selector
- * - MCU's ports and pins definitions and initializations
- * - USART Initialization
- * - Intro screen (just for fun ;) and a bit for some debuging purposes)
- * - Infinite loop
- *		- Show menu. Since this is slow process call this function only when the menu is to be updated (e.g. button is pressed)
- *		- Check buttons and act respectively. Consider debouncing delays.
- *
- */
-int main(void)
-{
-	// initialize first menu item after the menu header/title from main menu
-	selected = 1;		
-	
-	// MCUs ports initializations
-	OUTPUT(myLed_dirPort, myLed);				// port C, pin 5 as output (red LED)
-	CLEAR(myLed_dataPort, myLed);					// set it to LOW (LED is OFF)
-	INPUT(buttonEnter_dirPort, buttonEnter);	// set port C data direction register pin 4 as input (button "enter")
-	SET(buttonEnter_dataPort, buttonEnter);         // set its latch to HIGH (not pressed)
-	INPUT(buttonEnter_dirPort, buttonUp);		// set port C data direction register pin 4 as input (button "up")
-	SET(buttonEnter_dataPort, buttonUp);			// set its latch to HIGH (not pressed)
-	INPUT(buttonEnter_dirPort, buttonDown);		// set port C data direction register pin 4 as input (button "down")
-	SET(buttonEnter_dataPort, buttonDown);          // set its latch to HIGH (not pressed)	
-	INPUT(buttonEnter_dirPort, rotaryData);		// set port C data direction register pin 1 as input (ROTARY DATA)
-	SET(buttonEnter_dataPort, rotaryData);			// set its latch to HIGH (not pressed)	
-	INPUT(buttonEnter_dirPort, rotatyCLK);		// set port C data direction register pin 0 as input (ROTARY CLOCK)
-	SET(buttonEnter_dataPort, rotatyCLK);			// set its latch to HIGH (not pressed)	
-
-	// USART Initialization in asynchronous mode, 8bits, 1 stop bit, no parity, 1115200kb baud rate                                                                
-	UART0_Init (UART_BAUD, UART_DOUBLE_SPEED, UART_DATA_LENGTH, NO_PARITY);
-
-	debounceDelayInit();
-	
-	serialGLCD_clear();
-	_delay_ms(2000);
-	start();
-
-	// infinite loop - show menu and polling external events (buttons, encoder) respectively
-    while (1) 
-    {
-		if (update_menu == 1)
-		{
-			show_menu();
-			update_menu = 0;
-			
-			// update lastStateROTARY_CK due to delay introduced by show_menu()
-			rotary_delay = ROTARY_DELAY;
-			temp = 0;
-			while (rotary_delay)
-			{
-				lastStateROTARY_CK = read_PINx_digital_level(rotatyCLK_pinPort, rotatyCLK);
-				_delay_us(100);
-				temp = read_PINx_digital_level(rotatyCLK_pinPort, rotatyCLK);
-				
-				if (temp == lastStateROTARY_CK)
-				{
-					rotary_delay --;
-				} else {
-					rotary_delay = ROTARY_DELAY;
-				}
-			}				
-		}
-		
-		// check button status with debouncing
-		if (checkButton_withMode(onClick, buttonEnter_pinPort, buttonEnter, DEBOUNCE_DELAY))
-		{
-			TOGGLE(myLed_dataPort, myLed);
-			update_menu = 1;
-			selected  = my_menu[selected].enter;
-			if (my_menu[selected].fp != 0) my_menu[selected].fp();						
-		} // 'enter' button is the same also for rotary 'push' switch 
-
-		else if  (checkButton_withMode(whilePressed, buttonUp_pinPort, buttonUp, DEBOUNCE_DELAY)) 
-		{
-			TOGGLE(myLed_dataPort, myLed);
-			selected  = my_menu[selected].up;
-			update_menu = 1;
-		} 
-		else if  (checkButton_withMode(whilePressed, buttonDown_pinPort, buttonDown, DEBOUNCE_DELAY)) 
-		{
-			TOGGLE(myLed_dataPort, myLed);
-			selected  = my_menu[selected].down;
-			update_menu = 1;	
-		} 
-		// check rotary encoder
-		rotary_delay = ROTARY_DELAY;
-		temp = 0;
-		while (rotary_delay)
-		{			
-			currentStateROTARY_CK = read_PINx_digital_level(rotatyCLK_pinPort, rotatyCLK);
-			_delay_us(100);
-			temp = read_PINx_digital_level(rotatyCLK_pinPort, rotatyCLK);
-						
-			if (temp == currentStateROTARY_CK)
-			{
-				rotary_delay --;			
-				currentStateROTARY_DA = read_PINx_digital_level(rotaryData_pinPort, rotaryData);			
-			} else {
-				rotary_delay = ROTARY_DELAY;
-			}
-		}		
-		if (currentStateROTARY_CK != lastStateROTARY_CK) 
-		{
-			if (currentStateROTARY_CK == currentStateROTARY_DA) 
-			{
-				selected  = my_menu[selected].up;
-				update_menu = 1;
-				SET(myLed_dataPort, myLed);
-			} else {
-				selected  = my_menu[selected].down;
-				update_menu = 1;
-				CLEAR(myLed_dataPort, myLed);				
-			}
-			lastStateROTARY_CK = currentStateROTARY_CK;
-		}		
-		if (!(update_menu))
-		{
-			rotary_delay = ROTARY_DELAY;
-			temp = 0;
-			while (rotary_delay)
-			{
-				lastStateROTARY_CK = read_PINx_digital_level(rotatyCLK_pinPort, rotatyCLK);
-				_delay_us(100);
-				temp = read_PINx_digital_level(rotatyCLK_pinPort, rotatyCLK);
-			
-				if (temp == lastStateROTARY_CK)
-				{
-					rotary_delay --;
-				} else {
-					rotary_delay = ROTARY_DELAY;
-				}
-			}
-		}
-    }
-}
-
-/** ##Menu Handler - example function linked to selected menu item
- * 
- * This function is just an example to demonstrate how to 
- * link an executable code to particular selected menu item when an 
- * event "enter" occurs (button pressed, encoder, etc).
- *
- * Consider UART was initialized and enabled if LCD operation.
- *
- */
-void start (void)
-{
-	serialGLCD_clear();
-	serialGLCD_goto21x8_XY(1, 3);
-	serialGLCD_sendString("Serial GLCD trials");
-	_delay_ms(2000);
-	selected = 1;
-	serialGLCD_clear();
-	_delay_ms(2);
-}
-
-
-/** ##Menu Handler - example rotary encoder application function
- * 
- * This function is just an example to demonstrate how to 
- * link an executable code to particular selected menu item when an 
- * event "enter" occurs (button pressed, encoder, etc).
- *
- * Counter from 0 to 100 is controlled by rotary encoder and displayed on the screen
- *
- * Concept:
- *  - once called, this function is keeping the control loop until rotary push switch is pressed
- *  - display is cleared
- *  - rotary encoder handler:
- *     - refresh valid state of the ROTARY_CK (once at the beginning of the called function)
- *	   - go into loop (exit the loop when rotary switch is pressed)
- *	   - within the loop: 
- *			- check status of the ROTARY_CK (clock signal), if different than the previous it is supposed a rotation is ongoing
- *			- if a rotation is ongoing, check status of ROTARY_DA (data signal). 
- *          - if CK and DA in the same state decrement the counter, else increment
- *          - use LED output for additional outside indication of rotation direction 
- *	
- *		- each time CK or DA pin status is checked - do it in a loop until de-bounced confident result is achieved (the usage of ROTARY_DELAY)
- * 
- * Use 'sprintf(ResultString, "%d", myCounter);' to convert binary (unsigned char) counter into string for LCD display
- * - clear the remains symbols when go back to less digits range (100 -> 99, 10 -> 9, etc)
- */
-void rotary_counter (void)
-{
-	static unsigned char myCounter = 50;
-	char ResultString[5];	
-	unsigned char go_further = 1;
-	
-	serialGLCD_clear();
-	update_menu = 1;
-	_delay_ms(200);
-	
-	rotary_delay = ROTARY_DELAY;
-	temp = 0;
-	while (rotary_delay)
-	{
-		lastStateROTARY_CK = read_PINx_digital_level(PINC, rotatyCLK);
-		_delay_us(100);
-		temp = read_PINx_digital_level(PINC, rotatyCLK);
-			
-		if (temp == lastStateROTARY_CK)
-		{
-			rotary_delay --;
-		} else {
-			rotary_delay = ROTARY_DELAY;
-		}
-	}	
-	
-	while (go_further)
-	{
-
-		rotary_delay = ROTARY_DELAY;
-		temp = 0;
-		while (rotary_delay)
-		{
-			currentStateROTARY_CK = read_PINx_digital_level(PINC, rotatyCLK);
-			_delay_us(20);
-			temp = read_PINx_digital_level(PINC, rotatyCLK);
-				
-			if (temp == currentStateROTARY_CK)
-			{
-				rotary_delay --;
-				currentStateROTARY_DA = read_PINx_digital_level(PINC, rotaryData);
-			} 
-			else 
-			{
-				rotary_delay = ROTARY_DELAY;
-			}
-		}
-		if (currentStateROTARY_CK != lastStateROTARY_CK)
-		{
-			if (currentStateROTARY_CK == currentStateROTARY_DA)
-			{
-				if (myCounter) myCounter--;			// stops at 0
-				SET(myLed_dataPort, myLed);
-			} 
-			else 
-			{
-				if (myCounter < 100) myCounter++;	// stops at 100
-				CLEAR(myLed_dataPort, myLed);
-			}
-			update_menu = 1;
-		}
-		
-		if (update_menu) 
-		{
-			sprintf(ResultString, "%d", myCounter);
-			serialGLCD_goto21x8_XY(0, 0);
-			serialGLCD_sendString ("Count (0 - 100)");
-			serialGLCD_goto21x8_XY(0, 1);
-			serialGLCD_sendString (strcat(ResultString, " ")); // with cleaning the remains when change the number of digits
-			update_menu = 0;
-		}
-
-		rotary_delay = ROTARY_DELAY;
-		temp = 0;
-		while (rotary_delay)
-		{
-			lastStateROTARY_CK = read_PINx_digital_level(PINC, rotatyCLK);
-			_delay_us(20);
-			temp = read_PINx_digital_level(PINC, rotatyCLK);
-				
-			if (temp == lastStateROTARY_CK)
-			{
-				rotary_delay --;
-			} 
-			else 
-			{
-				rotary_delay = ROTARY_DELAY;
-			}
-		}
-	
-		if (checkButton_withMode(onClick, buttonEnter_pinPort, buttonEnter, DEBOUNCE_DELAY))
-		{
-			update_menu = 1;
-			go_further = 0;
-		}
-	}
-	selected = 1;
-	serialGLCD_clear();
-	_delay_ms(2);
-}
-
-
+/** \mainpage Main
+ * # Utilize serial backpack GLCD ADM12864H
+ *
+ * main.c
+ *
+ * \author	Simeon Neykov
+ * 
+ * [Used demos](https://www.avrfreaks.net/forum/tut-c-bit-manipulation-aka-programming-101?name=PNphpBB2&file=viewtopic&t=37871)
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * ##Main function concept:
+ * - Definitions and initializations
+ *		- variables definition and initializations
+ *		- I/O ports and pins definitions and initializations
+ *		- USART (in this application UART mode used) initialization
+ * - Infinite loop
+ *		- show the menu
+ *		- pooling the events (up, down, enter, etc)
+ *		- browse the menu accordingly
+ */ 
+
+#include "main.h"
+#include <avr/io.h>
+#include <util/delay.h>
+#include "serialGLCD.h"
+#include "USART.h"
+#include "charMenu.h"
+#include "ports_and_pins.h"
+#include "glcdBar.h"
+#include "glcdPlot.h"
+#include "glcdText.h"
+#include "glcdEdit.h"
+#include "glcdScreen.h"
+#include "hd44780.h"
+#include "softUART.h"
+#include "timer.h"
+#include "timerWheel.h"
+#include "trace.h"
+#include "memory.h"
+#include "rotary.h"
+#include "repeat.h"
+#include "keypad.h"
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <stdio.h>
+#include <string.h>
+
+unsigned char update_menu = 1;
+
+#if (GLCD_SECOND_PANEL == TRUE)
+GLCD_Display serialGLCD_second;			///< second serial GLCD panel on software UART
+#endif
+
+#if (KEYPAD_ENABLE == TRUE)
+static const char keypad_layout[] = "123A456B789C*0#D";	///< legend of the keys, row by row. 'A' up, 'B' down, 'C' page up, 'D' page down, '#' enter
+#endif
+
+static void splash_stop(void);
+static void splash_boot(void);
+
+static unsigned long enterLow;		///< last time 'enter' was seen pressed, ms
+
+/** ##Main loop - debounced release of 'enter'
+ *
+ * The release is taken when the pin stays high for REPEAT_DEBOUNCE_MS, thus a bouncing contact does not enter twice.
+ * @return 1 released, 0 still pressed or bouncing
+ */
+static unsigned char enter_released(void)
+{
+	if (!PIN_LEVEL(PIN_BUTTON_ENTER))
+	{
+		enterLow = timer_millis();
+		return 0;
+	}
+	return ((timer_millis() - enterLow) >= REPEAT_DEBOUNCE_MS);
+}
+
+/** ##Main loop - enter the selected item, its handler is called
+ *
+ * The handler returns to the item it was entered from, no handler knows its place in the menu table.
+ */
+static void enter_selected(void)
+{
+	unsigned char item;
+	
+	splash_stop();
+	PIN_TOGGLE(PIN_LED);
+	update_menu = 1;
+	selected  = menu_enter(selected);
+	item = selected;
+	if (my_menu[item].fp != 0)
+	{
+		my_menu[item].fp(my_menu[item].context);
+		selected = item;
+	}
+	else menu_latencyStart();
+}
+
+/** \file
+ * ##Main function
+ *
+ * - Declare and initialize needed software variables
+ *		- buttonPressed_delay, buttonReleased_delay are used for push button debouncing	
+ *		- update_menu controls menu to be updated only when changes are supposed (button pressed, etc)
+ *		- initialize menu item selector
+ * - MCU's ports and pins definitions and initializations
+ * - USART Initialization
+ * - Intro screen (just for fun ;) and a bit for some debuging purposes)
+ * - Infinite loop
+ *		- Show menu. Since this is slow process call this function only when the menu is to be updated (e.g. button is pressed)
+ *		- Check buttons and act respectively. Consider debouncing delays.
+ *		- 'enter' acts on the debounced release (see enter_released()). While it is held the encoder and the 'up', 'down' buttons jump over
+ *		  first-letter groups (see menu_jump()) and the release does not enter.
+ *		- Key matrix (see keypad.c) acts on the press: 'A', 'B' move, 'C', 'D' move by a page, '#' enters.
+ *
+ */
+int main(void)
+{
+	int steps;
+	unsigned char events;
+#if (KEYPAD_ENABLE == TRUE)
+	unsigned char key;
+#endif
+	unsigned char enterHeld = 0;		// 'enter' is pressed, its action waits for the release
+	unsigned char enterJumped = 0;		// a jump was done while 'enter' was held, the release does not enter
+	
+	// initialize first menu item after the menu header/title from main menu
+	selected = 1;		
+	
+	// MCUs ports initializations
+	PIN_OUTPUT(PIN_LED);						// red LED as output
+	PIN_LOW(PIN_LED);							// set it to LOW (LED is OFF)
+	PIN_PULLUP(PIN_BUTTON_ENTER);				// buttons and rotary encoder as inputs, latch HIGH (not pressed)
+	PIN_PULLUP(PIN_BUTTON_UP);
+	PIN_PULLUP(PIN_BUTTON_DOWN);
+	PIN_PULLUP(PIN_ROTARY_DATA);
+	PIN_PULLUP(PIN_ROTARY_CLK);
+
+	// USART Initialization in asynchronous mode, 8bits, 1 stop bit, no parity, 1115200kb baud rate                                                                
+	UART0_Init (UART_BAUD, UART_DOUBLE_SPEED, UART_DATA_LENGTH, NO_PARITY);
+
+	debounceDelayInit();
+	
+	// time base for the display pacing and latency instrumentation
+	timer_init();
+	repeat_init();
+#if (KEYPAD_ENABLE == TRUE)
+	keypad_init();
+#endif
+#if (TRACE_ENABLE == TRUE)
+	trace_init();
+#endif
+	sei();
+	
+	// character LCD menu backend, serial GLCD is used for DISPLAY_GLCD
+	if (menu_display == &hd44780_menuDisplay) hd44780_init();
+	
+#if (GLCD_SECOND_PANEL == TRUE)
+	// second panel mirrors the menu
+	softUART_init();
+	serialGLCD_register(&serialGLCD_second, softUART_ready, softUART_transmit);
+	menu_display = &serialGLCD_mirrorMenuDisplay;
+#endif
+	
+	splash_boot();
+	rotary_sync();
+
+	// infinite loop - show menu and polling external events (buttons, encoder) respectively
+    while (1) 
+    {
+		if (update_menu == 1)
+		{
+			show_menu();
+			update_menu = 0;
+			
+			// edges during show_menu() could not be followed, take the current encoder position
+			rotary_sync();
+		}
+		
+		// check button status with debouncing, 'enter' acts on release unless used as the jump modifier
+		if (checkButton(onClick, PIN_BUTTON_ENTER, DEBOUNCE_DELAY))
+		{
+			enterHeld = 1;
+			enterJumped = 0;
+			enterLow = timer_millis();
+		}
+		else if (enterHeld && enter_released())
+		{
+			enterHeld = 0;
+			if (!enterJumped) enter_selected();
+		} // 'enter' button is the same also for rotary 'push' switch 
+
+		// 'up' and 'down' repeat while held (see repeat.c), the events of a slow redraw come together as one jump
+		else if ((events = repeat_take(REPEAT_KEY_UP)) != 0) 
+		{
+			splash_stop();
+			PIN_TOGGLE(PIN_LED);
+			selected = enterHeld ? menu_jump(selected, -events) : menu_move(selected, -events);
+			enterJumped |= enterHeld;
+			update_menu = 1;
+			menu_latencyStart();
+		} 
+		else if ((events = repeat_take(REPEAT_KEY_DOWN)) != 0) 
+		{
+			splash_stop();
+			PIN_TOGGLE(PIN_LED);
+			selected = enterHeld ? menu_jump(selected, events) : menu_move(selected, events);
+			enterJumped |= enterHeld;
+			update_menu = 1;
+			menu_latencyStart();	
+		} 
+#if (KEYPAD_ENABLE == TRUE)
+		// key matrix, presses only, the releases are dropped
+		else if ((key = keypad_take()) != KEYPAD_NONE)
+		{
+			if (!(key & KEYPAD_RELEASED) && (key < sizeof(keypad_layout) - 1))
+			{
+				steps = 0;
+				switch (keypad_layout[key])
+				{
+					case 'A': steps = -1; break;
+					case 'B': steps = 1; break;
+					case 'C': steps = -(DISPLAY_ROWS - 1); break;
+					case 'D': steps = DISPLAY_ROWS - 1; break;
+					case '#': enter_selected(); break;
+				}
+				if (steps)
+				{
+					splash_stop();
+					PIN_TOGGLE(PIN_LED);
+					selected = menu_move(selected, steps);
+					update_menu = 1;
+					menu_latencyStart();
+				}
+			}
+		}
+#endif
+		// check rotary encoder, a fast spin comes as one jump
+		steps = rotary_poll(menu_length(selected));
+		if (steps)
+		{
+			splash_stop();
+			if (steps < 0) PIN_HIGH(PIN_LED);
+			else PIN_LOW(PIN_LED);
+			selected = enterHeld ? menu_jump(selected, steps) : menu_move(selected, steps);
+			enterJumped |= enterHeld;
+			update_menu = 1;
+			menu_latencyStartAt(rotary_eventTicks());		// from the first detent, debouncing and collecting included
+		}		
+		if (!(update_menu))
+		{
+			// idle - software timers, prepare the likely next screens, scroll a long label, send what is queued
+			timerWheel_service();
+			menu_speculate();
+			menu_marquee();
+			serialGLCD_service();
+#if (TRACE_ENABLE == TRUE)
+			trace_drain();
+#endif
+		}
+    }
+}
+
+/** ##Menu Handler - example function linked to selected menu item
+ * 
+ * This function is just an example to demonstrate how to 
+ * link an executable code to particular selected menu item when an 
+ * event "enter" occurs (button pressed, encoder, etc).
+ *
+ * Consider UART was initialized and enabled if LCD operation.
+ *
+ * Splash time is shown with a progress bar, each step sends the delta region only.
+ * Nothing waits here: the bar steps are a periodic software timer (see timerWheel.c), the menu is shown
+ * when the splash is over. An input event during the splash ends it (see splash_stop()), the menu is shown right
+ * away and the event acts on it. The splash ends on the item it was started from (the first item after reset).
+ * After reset the screen stays blank for SPLASH_BOOT_MS before the splash, a one-shot timer as well (see splash_boot()),
+ * thus the input is served from reset on.
+ *
+ */
+#define SPLASH_STEPS	20				///< progress bar steps of the splash
+#define SPLASH_STEP_MS	100				///< Given in ms. Time of one step
+#define SPLASH_BOOT_MS	2000			///< Given in ms. Blank screen after reset, before the splash
+
+static BarWidget splashBar;
+static TimerWheelTimer splashTimer;
+static unsigned char splashStep;
+static unsigned char splashActive = 0;		///< splash is on the screen, its timer is armed
+
+/** ##Menu Handler - end the splash, the menu is to be shown
+ *
+ * Called where an input event is taken, thus a key press during the splash ends it before it acts on the menu.
+ * Nothing is done if the splash is not shown.
+ */
+static void splash_stop(void)
+{
+	if (!splashActive) return;
+	splashActive = 0;
+	timerWheel_cancel(&splashTimer);
+	serialGLCD_clear();
+	update_menu = 1;
+}
+
+/** ##Menu Handler - blank screen after reset is over, software timer callback
+ */
+static void start_boot(void *context)
+{
+	if (splashActive) start(0);
+}
+
+/** ##Menu Handler - splash after reset
+ *
+ * The screen is cleared and the splash is started by a one-shot timer after SPLASH_BOOT_MS. The splash counts as shown
+ * meanwhile, an input event ends it and the menu is shown right away. No splash on the character LCDs.
+ */
+static void splash_boot(void)
+{
+#ifndef DISPLAY_GLCD
+	return;				// the splash is drawn on the serial GLCD, a character LCD shows the menu right away
+#endif
+	serialGLCD_clear();
+	serialGLCD_flush();
+	splashActive = 1;
+	timerWheel_arm(&splashTimer, SPLASH_BOOT_MS, 0, start_boot, 0);
+	update_menu = 0;
+}
+
+/** ##Menu Handler - one step of the splash, software timer callback
+ */
+static void start_step(void *context)
+{
+	if (!splashActive) return;
+	if (splashStep < SPLASH_STEPS)
+	{
+		glcdBar_update(&splashBar, ++splashStep);
+		return;
+	}
+	splash_stop();
+}
+
+void start (const void *context)
+{
+	serialGLCD_clear();
+	// centered for any display geometry, e.g. text row 3 and bar at 12, 40 for 128x64
+	serialGLCD_goto21x8_XY((GLCD_COLS - 18) / 2, GLCD_ROWS / 2 - 1);
+	serialGLCD_sendString("Serial GLCD trials");
+	glcdBar_init(&splashBar, (GLCD_PIXELS_X - 104) / 2, GLCD_CELL_Y(GLCD_ROWS / 2 + 1), 100, BAR_HORIZONTAL, 0, SPLASH_STEPS);
+	splashStep = 0;
+	splashActive = 1;
+	timerWheel_arm(&splashTimer, SPLASH_STEP_MS, SPLASH_STEP_MS, start_step, 0);
+	update_menu = 0;
+}
+
+
+/** ##Menu Handler - generic parameter editor, one function for any number of parameter items
+ * 
+ * The item gives a MenuParam descriptor as its 'context' (see my_menu[] in charMenu.c): title, bound variable,
+ * range and an optional function applying the new value. A parameter item costs its descriptor only,
+ * no function of its own. The descriptors are in flash (PROGMEM), they are read with pgm_read_*() on entry.
+ *
+ * Concept:
+ *  - once called, this function is keeping the control loop until rotary push switch is pressed
+ *  - screen is a declarative layout (see glcdScreen.c): the title is drawn once on entry, the value field is bound to the variable
+ *  - rotary encoder handler (see rotary.c):
+ *     - refresh valid state of the ROTARY_CK (once at the beginning of the called function and after each redraw)
+ *	   - go into loop (exit the loop when rotary switch is pressed)
+ *	   - within the loop: 
+ *			- rotary_poll() gives the number of steps, negative when CK and DA are in the same state (decrement the value)
+ *			- fast spin gives bigger steps (limited by the range max - min) and comes as one jump, thus one redraw per spin
+ *			- buttons 'up' and 'down' increment and decrement as well, with auto-repeat while held
+ *          - use LED output for additional outside indication of rotation direction 
+ *  - glcdScreen_update() sends the value field only when the value changed, 3 cells wide thus the remains 
+ *    of more digits are cleaned (100 -> 99, 10 -> 9, etc)
+ *  - character LCD (no DISPLAY_GLCD): the title and the value are rows written through menu_display, the value
+ *    row only when the value changed, padded to the row width
+ *  - returns to the item it was called from
+ *
+ * @param context MenuParam descriptor of the item
+ *
+ */
+static unsigned char myCounter = 50;
+static unsigned char myBacklight = 100;
+
+MenuParam counter_param PROGMEM = { "Count (0 - 100)", &myCounter, 0, 100, 0 };					///< "Rotary Counter" item
+MenuParam backlight_param PROGMEM = { "Backlight (0 - 100)", &myBacklight, 0, 100, serialGLCD_backlight };	///< "Backlight" item, applied while turning
+
+void param_edit (const void *context)
+{
+	MenuParam *param = (MenuParam *)context;
+	unsigned char *variable = pgm_read_ptr(&param->value);
+	unsigned char min = pgm_read_byte(&param->min);
+	unsigned char max = pgm_read_byte(&param->max);
+	void (*apply)(unsigned char) = (void (*)(unsigned char))pgm_read_ptr(&param->apply);
+#ifdef DISPLAY_GLCD
+	ScreenText paramTexts[] = { {0, 0, pgm_read_ptr(&param->title)} };
+	ScreenField paramFields[] = { {0, 1, 3, SCREEN_UCHAR, variable, 0} };
+	ScreenLayout paramScreen = { paramTexts, SCREEN_COUNT(paramTexts), paramFields, SCREEN_COUNT(paramFields) };
+#else
+	char ResultString[INITIAL_MAXX + 1];
+	unsigned char shown = ~*variable;		// differs, the value is written first time through
+#endif
+	int steps;
+	int value;
+	
+#ifdef DISPLAY_GLCD
+	serialGLCD_clear();
+	glcdScreen_show(&paramScreen);
+	serialGLCD_flush();
+#else
+	// character LCD, the title and the value are rows of the menu backend
+	menu_display->clear();
+	menu_display->writeString(0, 0, pgm_read_ptr(&param->title), 1, ' ');
+#endif
+	rotary_sync();
+	
+	repeat_take(REPEAT_KEY_UP);			// drop the events from before
+	repeat_take(REPEAT_KEY_DOWN);
+	while (!checkButton(onClick, PIN_BUTTON_ENTER, DEBOUNCE_DELAY))
+	{
+		steps = rotary_poll(max - min + 1) + repeat_take(REPEAT_KEY_UP) - repeat_take(REPEAT_KEY_DOWN);
+		if (steps)
+		{
+			value = *variable + steps;
+			if (value < min) value = min;		// stops at min
+			if (value > max) value = max;		// stops at max
+			*variable = value;
+			if (apply) apply(value);
+			if (steps < 0) PIN_HIGH(PIN_LED);
+			else PIN_LOW(PIN_LED);
+		}
+		
+#ifdef DISPLAY_GLCD
+		if (glcdScreen_update(&paramScreen)) 
+		{
+			serialGLCD_flush();
+			rotary_sync();
+		}
+#else
+		if (shown != *variable)
+		{
+			shown = *variable;
+			snprintf(ResultString, sizeof(ResultString), "%u", shown);
+			menu_display->writeString(0, 1, ResultString, 1, ' ');
+			rotary_sync();
+		}
+#endif
+	}
+	menu_display->clear();
+	if (menu_display->flush) menu_display->flush();
+	_delay_ms(2);
+}
+
+/** ##Menu Handler - text screen of a handler, any display
+ *
+ * Lines are written through the menu backend (see menu_display), thus the character LCDs show them as well.
+ * A display with less rows than lines scrolls by the rotary encoder and buttons 'up' and 'down'.
+ * Returns on enter, the screen is cleared.
+ * @param lines Text of the lines, cut to the display width
+ * @param count Number of lines
+ *
+ */
+static void handler_lines(char (*lines)[INITIAL_MAXX + 1], unsigned char count)
+{
+	unsigned char last = (count > DISPLAY_ROWS) ? count - DISPLAY_ROWS : 0;
+	unsigned char top = 0;
+	unsigned char redraw = 1;
+	unsigned char row;
+	int steps;
+	int value;
+	
+	menu_display->clear();
+	rotary_sync();
+	repeat_take(REPEAT_KEY_UP);			// drop the events from before
+	repeat_take(REPEAT_KEY_DOWN);
+	while (!checkButton(onClick, PIN_BUTTON_ENTER, DEBOUNCE_DELAY))
+	{
+		steps = rotary_poll(last + 1) + repeat_take(REPEAT_KEY_DOWN) - repeat_take(REPEAT_KEY_UP);
+		if (steps)
+		{
+			value = top + steps;
+			if (value < 0) value = 0;
+			if (value > last) value = last;
+			redraw = (value != top);
+			top = value;
+		}
+		if (redraw)
+		{
+			for (row = 0; (row < DISPLAY_ROWS) && (top + row < count); row++)
+			{
+				menu_display->writeString(0, row, lines[top + row], 1, ' ');
+			}
+			if (menu_display->flush) menu_display->flush();
+			redraw = 0;
+			rotary_sync();
+		}
+	}
+	menu_display->clear();
+	if (menu_display->flush) menu_display->flush();
+}
+
+/** ##Menu Handler - latency instrumentation screen
+ * 
+ * Shows average time from an input event (button, encoder) to the first byte of the new menu screen on the wire,
+ * separately for speculative pre-render enabled and disabled (see menu_speculate()), with the number of events.
+ * An encoder event is timed from its first detent, thus the debouncing and ROTARY_COALESCE_MS are included.
+ * Lines are cut to the display width, long values are never written past the line. Shown by handler_lines(),
+ * a 2 or 4 row character LCD scrolls through them.
+ *
+ * Enter toggles the speculation and returns to the menu, thus both modes could be compared on the target.
+ *
+ */
+void latency_stats (const void *context)
+{
+	char lines[6][INITIAL_MAXX + 1];
+	unsigned char count = 0;
+	unsigned char mode;
+	
+	snprintf(lines[count++], sizeof(lines[0]), "Latency [us]");
+	for (mode = 0; mode < 2; mode++)
+	{
+		snprintf(lines[count++], sizeof(lines[0]), "%s %lu (%u)", mode ? "on " : "off",
+			menu_latencyCount[mode] ? menu_latencySum[mode] / menu_latencyCount[mode] : 0UL, menu_latencyCount[mode]);
+	}
+	snprintf(lines[count++], sizeof(lines[0]), "last %u", menu_latencyLast);
+#if (KEYPAD_ENABLE == TRUE)
+	// key matrix scan in the Timer0 interrupt, Timer1 ticks to us, ghost combinations
+	snprintf(lines[count++], sizeof(lines[0]), "keys %lu/%u g%u",
+		keypad_scanCount ? keypad_scanSum * TIMER_TICK_US / keypad_scanCount : 0UL, keypad_scanMax * TIMER_TICK_US, keypad_ghosts);
+#endif
+	snprintf(lines[count++], sizeof(lines[0]), menu_speculation ? "Enter: spec off" : "Enter: spec on");
+	handler_lines(lines, count);
+	
+	menu_speculation = !menu_speculation;
+	_delay_ms(2);
+}
+
+
+/** ##Menu Handler - SRAM usage screen
+ * 
+ * Shows the static SRAM (.data, .bss), the deepest stack usage since reset and the SRAM never touched so far,
+ * see memory.c. Navigate through the menus and handlers first to get a meaningful high-water mark.
+ * Shown by handler_lines(), any display.
+ *
+ * Enter returns to the menu.
+ *
+ */
+void memory_stats (const void *context)
+{
+	char lines[5][INITIAL_MAXX + 1];
+	
+	snprintf(lines[0], sizeof(lines[0]), "SRAM [bytes]");
+	snprintf(lines[1], sizeof(lines[0]), "static %u", memory_static());
+	snprintf(lines[2], sizeof(lines[0]), "stack max %u", memory_stackHighWater());
+	snprintf(lines[3], sizeof(lines[0]), "never used %u", memory_stackUnused());
+	snprintf(lines[4], sizeof(lines[0]), "free now %u", memory_free());
+	handler_lines(lines, 5);
+	_delay_ms(2);
+}
+
+/** ##Menu Handler - word wrapped text example
+ * 
+ * Longer text shown in the upper 7 rows by the text layout widget (see glcdText.c), the last row shows the page.
+ * Rotary encoder and buttons 'up' and 'down' step through the pages, each page is one redraw.
+ *
+ * Enter returns to the menu.
+ *
+ */
+void about_text (const void *context)
+{
+	static const char about[] = "Serial GLCD menu for the SparkFun Graphic LCD Serial Backpack on ATmega328P. "
+		"Navigate with the rotary encoder or the buttons, enter opens a submenu or calls its function.\n"
+		"Output is queued and paced per byte, thus the main loop never waits for the backpack. "
+		"Long texts like this one are word wrapped once and shown page by page.";
+	TextWidget text;
+	char ResultString[GLCD_COLS + 1];
+	unsigned char page = 0;
+	unsigned char redraw = 1;
+	int steps;
+	int value;
+	
+	serialGLCD_clear();
+	glcdText_init(&text, 0, 0, GLCD_COLS, GLCD_ROWS - 1, about);
+	rotary_sync();
+	repeat_take(REPEAT_KEY_UP);			// drop the events from before
+	repeat_take(REPEAT_KEY_DOWN);
+	while (!checkButton(onClick, PIN_BUTTON_ENTER, DEBOUNCE_DELAY))
+	{
+		steps = rotary_poll(glcdText_pages(&text)) + repeat_take(REPEAT_KEY_DOWN) - repeat_take(REPEAT_KEY_UP);
+		if (steps)
+		{
+			value = page + steps;
+			if (value < 0) value = 0;
+			if (value > glcdText_pages(&text) - 1) value = glcdText_pages(&text) - 1;
+			redraw = (value != page);
+			page = value;
+		}
+		if (redraw)
+		{
+			glcdText_show(&text, page);
+			sprintf(ResultString, "page %u/%u", page + 1, glcdText_pages(&text));
+			serialGLCD_goto21x8_XY(GLCD_COLS - strlen(ResultString), GLCD_ROWS - 1);
+			serialGLCD_sendString(ResultString);
+			serialGLCD_flush();
+			redraw = 0;
+			rotary_sync();
+		}
+	}
+	serialGLCD_clear();
+	serialGLCD_flush();
+	_delay_ms(2);
+}
+
+/** ##Menu Handler - text entry example, device name
+ *
+ * The name is edited in place by the text entry widget (see glcdEdit.c): rotary encoder and buttons 'up' and 'down'
+ * cycle the character at the caret, enter moves the caret to the next character, enter on the last one returns to the menu.
+ * A step sends the changed character only, the caret blinks by a software timer, thus the loop serves the wheel
+ * and the output queue instead of waiting for them.
+ *
+ */
+#define NAME_LENGTH		16				///< characters of the device name
+
+static char deviceName[NAME_LENGTH + 1] = "SERIAL GLCD";
+
+void name_edit (const void *context)
+{
+	EditWidget edit;
+	int steps;
+	
+	serialGLCD_clear();
+	serialGLCD_goto21x8_XY(0, 0);
+	serialGLCD_sendString("Device name");
+	glcdEdit_init(&edit, 0, 2, NAME_LENGTH, EDIT_ALPHABET_NAME, deviceName);
+	glcdEdit_show(&edit);
+	serialGLCD_goto21x8_XY(0, 5);
+	serialGLCD_sendString("Turn: letter");
+	serialGLCD_goto21x8_XY(0, 6);
+	serialGLCD_sendString("Enter: next / done");
+	rotary_sync();
+	repeat_take(REPEAT_KEY_UP);			// drop the events from before
+	repeat_take(REPEAT_KEY_DOWN);
+	for (;;)
+	{
+		if (checkButton(onClick, PIN_BUTTON_ENTER, DEBOUNCE_DELAY))
+		{
+			if (glcdEdit_next(&edit)) break;
+		}
+		steps = rotary_poll(sizeof(EDIT_ALPHABET_NAME) - 1) + repeat_take(REPEAT_KEY_UP) - repeat_take(REPEAT_KEY_DOWN);
+		if (steps) glcdEdit_step(&edit, steps);
+		timerWheel_service();
+		serialGLCD_service();
+	}
+	glcdEdit_close(&edit);
+	serialGLCD_clear();
+	serialGLCD_flush();
+	_delay_ms(2);
+}
+
+/** ##Menu Handler - streaming plot example
+ *
+ * A triangle test signal is plotted by the plot widget (see glcdPlot.c), one sample per PLOT_DEMO_MS from a periodic
+ * software timer. The loop serves the wheel and the output queue, nothing waits for the backpack.
+ * The link time of a sample (its commands queued until the last byte is loaded into the UART, pacing included) is measured for the
+ * samples queued while the output was idle. Row 1 shows its mean and maximum and the sample rate reached.
+ *
+ * Enter returns to the menu.
+ *
+ */
+#define PLOT_DEMO_MS		50				///< Given in ms. Sample period of the plot example, 20 samples per second
+#define PLOT_DEMO_PERIOD	32				///< samples per period of the test signal, power of 2
+#define PLOT_DEMO_STATS		20				///< measured samples between two updates of the statistics row
+
+typedef struct PlotDemoStructure {
+	/*@{*/
+	PlotWidget plot;
+	TimerWheelTimer timer;					/**< sample period */
+	unsigned char phase;					/**< sample of the test signal period */
+	unsigned int samples;					/**< samples plotted */
+	/*@}*/
+	/*@{*/
+	unsigned long queued;					/**< time stamp (timer ticks) the measured sample was queued, 0 if none is pending */
+	unsigned int measured;					/**< samples measured */
+	unsigned long sum;						/**< link time of the measured samples in timer ticks */
+	unsigned long max;						/**< longest link time of a sample in timer ticks */
+	/*@}*/
+}PlotDemo;
+
+/** ##Menu Handler - one sample of the plot example, software timer callback
+ */
+static void plot_sample(void *context)
+{
+	PlotDemo *demo = (PlotDemo *)context;
+	unsigned char idle = !serialGLCD_busy();
+	unsigned long now = timer_ticks();
+	int sample = (demo->phase < PLOT_DEMO_PERIOD / 2) ? demo->phase : PLOT_DEMO_PERIOD - demo->phase;
+	
+	glcdPlot_addSample(&demo->plot, sample);
+	demo->queued = idle ? now : 0;			// a sample queued behind other output is not measured
+	demo->phase = (demo->phase + 1) & (PLOT_DEMO_PERIOD - 1);
+	demo->samples++;
+}
+
+void plot_demo (const void *context)
+{
+	PlotDemo demo;
+	char ResultString[GLCD_COLS + 1];
+	unsigned long start;
+	unsigned long ticks;
+	unsigned int mean;
+	unsigned int longest;
+	unsigned int rate;
+	
+	serialGLCD_clear();
+	serialGLCD_goto21x8_XY(0, 0);
+	serialGLCD_sendString("Plot, link/sample");
+	glcdPlot_init(&demo.plot, 0, GLCD_CELL_Y(2), PLOT_BUFFER_SIZE, GLCD_PIXELS_Y - GLCD_CELL_Y(2), 0, PLOT_DEMO_PERIOD / 2);
+	serialGLCD_flush();
+	demo.phase = 0;
+	demo.samples = 0;
+	demo.queued = 0;
+	demo.measured = 0;
+	demo.sum = 0;
+	demo.max = 0;
+	demo.timer.armed = 0;
+	start = timer_ticks();
+	timerWheel_arm(&demo.timer, PLOT_DEMO_MS, PLOT_DEMO_MS, plot_sample, &demo);
+	while (!checkButton(onClick, PIN_BUTTON_ENTER, DEBOUNCE_DELAY))
+	{
+		timerWheel_service();
+		serialGLCD_service();
+		if (!demo.queued || serialGLCD_busy()) continue;
+		
+		ticks = timer_ticks() - demo.queued;
+		demo.queued = 0;
+		demo.sum += ticks;
+		if (ticks > demo.max) demo.max = ticks;
+		if (++demo.measured % PLOT_DEMO_STATS) continue;
+		
+		// mean and max in 0.1ms, samples per second since the start
+		mean = demo.sum * TIMER_TICK_US / demo.measured / 100;
+		longest = demo.max * TIMER_TICK_US / 100;
+		rate = (unsigned long)demo.samples * 1000 / ((timer_ticks() - start) / TIMER_TICKS_PER_MS);
+		if (mean > 999) mean = 999;			// fits the row, 99.9ms
+		if (longest > 999) longest = 999;
+		if (rate > 999) rate = 999;
+		sprintf(ResultString, "%u.%u/%u.%ums %u/s ", mean / 10, mean % 10, longest / 10, longest % 10, rate);
+		serialGLCD_goto21x8_XY(0, 1);
+		serialGLCD_sendString(ResultString);
+	}
+	timerWheel_cancel(&demo.timer);
+	serialGLCD_clear();
+	serialGLCD_flush();
+	_delay_ms(2);
+}
+
+/** ##Menu Handler - example of a virtual list, sorted device IDs
+ *
+ * Items are not stored anywhere, the label of an item is generated from its index when the menu handler asks for it
+ * (only the rows in the visible window). 'device_list' is linked to the menu item "-<Devices>-" entered from "Device list" (see charMenu.c).
+ */
+#define DEVICE_GROUPS	25							///< devices are named by group letter and number, "A-00" .. "Y-39"
+#define DEVICE_COUNT	(DEVICE_GROUPS * 40)		///< number of devices in the list
+
+/** ##Virtual list - number of devices
+ */
+static unsigned int device_count(void)
+{
+	return DEVICE_COUNT;
+}
+
+/** ##Virtual list - label of a device, e.g. "B-07"
+ */
+static void device_label(unsigned int index, char *buffer, unsigned char size)
+{
+	snprintf(buffer, size, "%c-%02u", 'A' + index / (DEVICE_COUNT / DEVICE_GROUPS), index % (DEVICE_COUNT / DEVICE_GROUPS));
+}
+
+MenuList device_list = { device_count, device_label, 0 };	///< "enter" on a device returns to the sub-menu
\ No newline at end of file
@@ -1,88 +1,123 @@
-﻿/*
- * main.h
- *
- * \author	Simeon nEYKOV
- */ 
-#ifndef MAIN_H_
-#define MAIN_H_
-
-/*@{*/
-#define TRUE		1							///< General purpose macro definitions
-#define FALSE		0							///< General purpose macro definitions
-#define LOW			0							///< General purpose macro definitions
-#define HIGH		1							///< General purpose macro definitions
-/*@}*/
-
-
-/*@{*/
-#define F_CPU 16000000UL						///< System clock, used in <util/delay.h>
-/*@}*/
-
-#include <avr/io.h>
-#include <util/delay.h>
-	
-/*@{*/
-#define UART_DOUBLE_SPEED		1				///< Usage would depends of F_CPU and possible combinations between F_CPU, UART desired baud rate and needed prescaler
-#define UART_DATA_LENGTH		8				///< default needed for SparkFun serial GLCD backpack
-#define UART_STOP_BITS			1				///< default needed for SparkFun serial GLCD backpack
-#define UART_BAUD				1152			///< pre-scalled from 115200. Default needed for SparkFun serial GLCD backpack
-#define PARITY_EVEN				0				///< defines used EVEN parity check feature of UART
-#define PARITY_ODD				1				///< defines used ODD parity check feature of UART
-#define NO_PARITY				3				///< give a value different than 0 or 1 to distinguish PARITY ODD or EVEN selections 
-/*@}*/
-
-/*@{*/
-#define GLCD_DELAY				5				///< Given in ms. For use in wait_while_UART0_is_busy when it should send data to serial display
-#define DEBOUNCE_DELAY			0				///< Makes a common place to define number of cycles to pass in buttonPressed_delay and buttonReleased_delay
-#define ROTARY_DELAY			40				///< Used in rotary encoder handler as a number of cycles to check rotary pins state (debouncing)
-/*@}*/											
-
-/*@{*/
-// LED pins and registers mapping	
-#define myLed_dirPort			DDRC			///< Application specific names defined for MCU's ports and pins
-#define myLed_dataPort			PORTC			///< Application specific names defined for MCU's ports and pins
-#define myLed					5				///< Application specific names defined for MCU's ports and pins
-
-// push buttons MCU's pins and registers mapping
-#define buttonEnter_dirPort		DDRC			///< Application specific names defined for MCU's ports and pins
-#define buttonDown_dirPort		DDRC			///< Application specific names defined for MCU's ports and pins
-#define buttonUp_dirPort		DDRC			///< Application specific names defined for MCU's ports and pins
-
-#define buttonEnter_dataPort	PORTC			///< Application specific names defined for MCU's ports and pins
-#define buttonDown_dataPort		PORTC			///< Application specific names defined for MCU's ports and pins
-#define buttonUp_dataPort		PORTC			///< Application specific names defined for MCU's ports and pins
-
-#define buttonEnter_pinPort		PINC			///< Application specific names defined for MCU's ports and pins
-#define buttonDown_pinPort		PINC			///< Application specific names defined for MCU's ports and pins
-#define buttonUp_pinPort		PINC			///< Application specific names defined for MCU's ports and pins
-
-#define buttonEnter				4				///< Application specific names defined for MCU's ports and pins
-#define buttonDown				3				///< Application specific names defined for MCU's ports and pins
-#define buttonUp				2				///< Application specific names defined for MCU's ports and pins
-
-#define maxButtonNum			8				///< in a concept of a button directly connect to a port, there might be max of 8 buttons on one port
-
-// rotary encoder MCU's pins mapping
-// note use the same MCU port C, thus use the same registers mapping as for push buttons
-#define rotaryData_dirPort		DDRC			///< Application specific names defined for MCU's ports and pins
-#define rotatyCLK_dirPort		DDRC			///< Application specific names defined for MCU's ports and pins
-#define rotaryButton_dirPort	DDRC			///< Application specific names defined for MCU's ports and pins
-
-#define rotaryData_dataPort		PORTC			///< Application specific names defined for MCU's ports and pins
-#define rotaryCLK_dataPort		PORTC			///< Application specific names defined for MCU's ports and pins
-#define rotaryButton_dataPort	PORTC			///< Application specific names defined for MCU's ports and pins
-
-#define rotaryData				1				///< Application specific names defined for MCU's ports and pins
-#define rotatyCLK				0				///< Application specific names defined for MCU's ports and pins
-#define rotaryButton			4				///< Application specific names defined for MCU's ports and pins
-
-#define rotaryData_pinPort		PINC			///< Application specific names defined for MCU's ports and pins
-#define rotatyCLK_pinPort		PINC			///< Application specific names defined for MCU's ports and pins
-#define rotaryButton_pinPort	PINC			///< Application specific names defined for MCU's ports and pins
-
-/*@}*/
-
-extern void start (void);
-extern void rotary_counter (void);
-
+﻿/*
+ * main.h
+ *
+ * \author	Simeon nEYKOV
+ */ 
+#ifndef MAIN_H_
+#define MAIN_H_
+
+/*@{*/
+#define TRUE		1							///< General purpose macro definitions
+#define FALSE		0							///< General purpose macro definitions
+#define LOW			0							///< General purpose macro definitions
+#define HIGH		1							///< General purpose macro definitions
+/*@}*/
+
+
+/*@{*/
+#define F_CPU 16000000UL						///< System clock, used in <util/delay.h>
+/*@}*/
+
+#include <avr/io.h>
+#include <util/delay.h>
+#include "hal.h"
+	
+/*@{*/
+#define UART_DOUBLE_SPEED		1				///< Usage would depends of F_CPU and possible combinations between F_CPU, UART desired baud rate and needed prescaler
+#define UART_DATA_LENGTH		8				///< default needed for SparkFun serial GLCD backpack
+#define UART_STOP_BITS			1				///< default needed for SparkFun serial GLCD backpack
+#define UART_BAUD				1152			///< pre-scalled from 115200. Default needed for SparkFun serial GLCD backpack
+#define PARITY_EVEN				0				///< defines used EVEN parity check feature of UART
+#define PARITY_ODD				1				///< defines used ODD parity check feature of UART
+#define NO_PARITY				3				///< give a value different than 0 or 1 to distinguish PARITY ODD or EVEN selections 
+/*@}*/
+
+/*@{*/
+#define GLCD_DELAY				5				///< Given in ms. For use in wait_while_UART0_is_busy when it should send data to serial display
+#define DEBOUNCE_DELAY			0				///< Makes a common place to define number of cycles to pass in buttonPressed_delay and buttonReleased_delay
+#define ROTARY_DELAY			40				///< Used in rotary encoder handler as a number of cycles to check rotary pins state (debouncing)
+#define ROTARY_SAMPLE_US		100				///< Given in us. Time between the rotary encoder pin samples while debouncing
+/*@}*/
+
+/*@{*/
+#define ROTARY_ACCEL			TRUE			///< TRUE: rotary encoder steps grow with the rotation speed, see rotary.c
+#define ROTARY_ACCEL_SLOW_MS	150				///< Given in ms. Detents closer than this move by ROTARY_ACCEL_SLOW_STEP
+#define ROTARY_ACCEL_SLOW_STEP	2				///< step of a detent in a moderate turn
+#define ROTARY_ACCEL_FAST_MS	60				///< Given in ms. Detents closer than this move by ROTARY_ACCEL_FAST_STEP
+#define ROTARY_ACCEL_FAST_STEP	5				///< step of a detent in a fast spin
+#define ROTARY_ACCEL_TURBO_MS	25				///< Given in ms. Detents closer than this move by ROTARY_ACCEL_TURBO_STEP
+#define ROTARY_ACCEL_TURBO_STEP	20				///< step of a detent in a very fast spin
+#define ROTARY_ACCEL_SHARE		8				///< a detent moves by at most 1/ROTARY_ACCEL_SHARE of the range given to rotary_poll(), shorter ranges than 2*ROTARY_ACCEL_SHARE are not accelerated
+#define ROTARY_COALESCE_MS		40				///< Given in ms. Detents within this time are collected into one jump (one redraw)
+/*@}*/
+
+/*@{*/
+#define REPEAT_DEBOUNCE_MS		5				///< Given in ms. Button level must be stable this long (auto-repeat of 'up' and 'down', see repeat.c)
+#define REPEAT_DELAY_MS			400				///< Given in ms. Button held this long starts to repeat
+#define REPEAT_INTERVAL_MS		150				///< Given in ms. First repeat interval
+#define REPEAT_RAMP_MS			10				///< Given in ms. Each repeat shortens the interval by this, 0 for a constant rate
+#define REPEAT_FAST_MS			40				///< Given in ms. Shortest repeat interval at the end of the ramp
+/*@}*/
+
+/*@{*/
+#define GLCD_SECOND_PANEL		FALSE			///< TRUE: second serial GLCD on software UART mirrors the menu, both panels are refreshed in parallel
+#define GLCD_PEEPHOLE			TRUE			///< TRUE: serial GLCD commands pass a short window where redundant ones are dropped or merged, see serialGLCD.c
+#define TRACE_ENABLE			FALSE			///< TRUE: binary event trace drained over the software UART, see trace.c
+#define SOFTUART_BIT_DELAY		8.3				///< Given in us. Bit time at 115200 baud is 8.68us, reduced by the bit loop overhead
+/*@}*/
+
+/*@{*/
+#ifndef KEYPAD_ENABLE
+#define KEYPAD_ENABLE			FALSE			///< TRUE: key matrix scanned in the Timer0 interrupt, see keypad.c. Its rows take the HD44780 data pins, thus FALSE for a HD44780 menu display. Could be given on the command line as well (-DKEYPAD_ENABLE=TRUE)
+#endif
+#define KEYPAD_ROWS				4				///< rows of the key matrix (PIN_KEYPAD_ROW0 ..), at most 8. One row is scanned per 1ms tick
+#define KEYPAD_COLS				4				///< columns of the key matrix (PIN_KEYPAD_COL0 ..), at most 8
+#define KEYPAD_QUEUE			8				///< key events kept until the main loop takes them, power of 2
+/*@}*/											
+
+/*@{*/
+// pin descriptors: one definition per signal, port letter and pin number (see PIN_LEVEL() etc in ports_and_pins.h)
+#define PIN_LED					C, 5			///< red LED, active high
+#define PIN_BUTTON_ENTER		C, 4			///< push button "enter", the same pin is the rotary encoder push switch. Active low, pull-up
+#define PIN_BUTTON_DOWN			C, 3			///< push button "down". Active low, pull-up
+#define PIN_BUTTON_UP			C, 2			///< push button "up". Active low, pull-up
+#define PIN_ROTARY_DATA			C, 1			///< rotary encoder data (DA), pull-up
+#define PIN_ROTARY_CLK			C, 0			///< rotary encoder clock (CK), pull-up
+
+// key matrix, rows driven low one at a time (released to high impedance), columns are inputs with pull-up
+#define PIN_KEYPAD_ROW0			D, 4			///< shared with the HD44780 data line D4
+#define PIN_KEYPAD_ROW1			D, 5			///< shared with the HD44780 data line D5
+#define PIN_KEYPAD_ROW2			D, 6			///< shared with the HD44780 data line D6
+#define PIN_KEYPAD_ROW3			D, 7			///< shared with the HD44780 data line D7
+#define PIN_KEYPAD_COL0			B, 4
+#define PIN_KEYPAD_COL1			B, 5
+#define PIN_KEYPAD_COL2			D, 2
+#define PIN_KEYPAD_COL3			D, 3
+
+#define maxButtonNum			8				///< in a concept of a button directly connect to a port, there might be max of 8 buttons on one port
+
+// HD44780 character LCD pins mapping, 4-bit interface with busy flag read back (R/W connected)
+// note data lines D4..D7 use upper nibble of port D, thus UART0 pins PD0, PD1 are not affected
+#define lcdData_dirPort			DDRD			///< Application specific names defined for MCU's ports and pins
+#define lcdData_dataPort		PORTD			///< Application specific names defined for MCU's ports and pins
+#define lcdData_pinPort			HAL_PIND()		///< Application specific names defined for MCU's ports and pins
+#define lcdData_shift			4				///< D4 is connected to this pin, D5..D7 to the next pins respectively
+
+#define PIN_LCD_RS				B, 0			///< register select
+#define PIN_LCD_RW				B, 1			///< read / write
+#define PIN_LCD_E				B, 2			///< enable
+
+// software UART transmit pin, used for a second serial GLCD panel
+#define PIN_SOFTUART_TX			B, 3			///< idle high
+
+/*@}*/
+
+extern void start (const void *context);
+extern void param_edit (const void *context);
+extern void latency_stats (const void *context);
+extern void memory_stats (const void *context);
+extern void about_text (const void *context);
+extern void name_edit (const void *context);
+extern void plot_demo (const void *context);
+
 #endif /* MAIN_H_ */
\ No newline at end of file
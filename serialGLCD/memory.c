@@ -0,0 +1,86 @@
+﻿/** \page pageMemory SRAM usage and stack watermark
+ * 
+ * ##Stack painting at reset and high-water mark query
+ *
+ * memory.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - memory_paint() runs from section .init1, i.e. before the stack pointer is set and before .data / .bss are initialized
+ * - SRAM from the end of .bss (_end) to the top of the stack (__stack, RAMEND) is filled with MEMORY_CANARY
+ * - The stack grows down from __stack, the deepest byte ever written is found by scanning the canary up from _end
+ * - Heap (malloc) is not used in this application, otherwise it would grow up from _end and spoil the scan
+ * - A local variable may hold MEMORY_CANARY by chance, the high-water mark is then lower by a few bytes
+ *
+ * Static (.data, .bss) sizes per module are reported at build time from the linker map, see tools/mapBudget.c.
+ *
+ */
+
+#include <avr/io.h>
+#include "main.h"
+#include "memory.h"
+
+extern unsigned char _end;			///< end of .bss, provided by the linker script
+extern unsigned char __stack;		///< initial stack pointer (RAMEND), provided by the linker script
+
+void memory_paint(void) __attribute__ ((naked, used, section (".init1")));
+
+/** ##Stack painting - fills the free SRAM with the canary
+ *
+ * Runs before the C runtime is set up (no stack, r1 is not zero yet), thus assembler only.
+ * Never called, placed in .init1 by the linker.
+ * Not assembled and run on the target yet: "never used" of memory_stats() right after reset is to be about
+ * RAMEND - _end minus the few bytes of main() when the fill is working.
+ *
+ */
+void memory_paint(void)
+{
+	__asm volatile (
+		"	ldi r30, lo8(_end)		\n"
+		"	ldi r31, hi8(_end)		\n"
+		"	ldi r24, %[canary]		\n"
+		"	ldi r25, hi8(__stack)	\n"
+		"	rjmp 2f					\n"
+		"1:	st Z+, r24				\n"
+		"2:	cpi r30, lo8(__stack)	\n"
+		"	cpc r31, r25			\n"
+		"	brlo 1b					\n"
+		"	breq 1b					\n"
+		:: [canary] "M" (MEMORY_CANARY)
+	);
+}
+
+/** ##Static SRAM - .data and .bss size in bytes
+ */
+unsigned int memory_static(void)
+{
+	return (unsigned int)&_end - RAMSTART;
+}
+
+/** ##Stack watermark - bytes never written since reset
+ *
+ * Scans the canary from the end of .bss up, takes less than 1ms on 2KB SRAM.
+ * @return bytes left to a stack / .bss collision in the worst case seen so far
+ *
+ */
+unsigned int memory_stackUnused(void)
+{
+	const unsigned char *p = &_end;
+	
+	while ((p <= &__stack) && (*p == MEMORY_CANARY)) p++;
+	return (unsigned int)(p - &_end);
+}
+
+/** ##Stack watermark - the deepest stack usage since reset in bytes
+ */
+unsigned int memory_stackHighWater(void)
+{
+	return (unsigned int)(&__stack - &_end) + 1 - memory_stackUnused();
+}
+
+/** ##Free SRAM right now - bytes between the end of .bss and the current stack pointer
+ */
+unsigned int memory_free(void)
+{
+	return SP - (unsigned int)&_end;
+}
@@ -0,0 +1,19 @@
+﻿/*
+ * memory.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef MEMORY_H_
+#define MEMORY_H_
+
+/*@{*/
+#define MEMORY_CANARY		0xC5				///< SRAM between the end of .bss and the top of the stack is painted with this value at reset
+/*@}*/
+
+unsigned int memory_static(void);
+unsigned int memory_stackHighWater(void);
+unsigned int memory_stackUnused(void);
+unsigned int memory_free(void);
+
+#endif /* MEMORY_H_ */
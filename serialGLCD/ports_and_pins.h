@@ -1,34 +1,67 @@
-﻿/*
- * ports_and_pins.h
- *
- * \author Simeon Neykov
- *
- */ 
-
-#ifndef PORTS_AND_PINS_H_
-#define PORTS_AND_PINS_H_
-
-enum {
-	whilePressed = 0,
-	onClick = 1,
-};
-
-// AVR MCU's ports and pins MACRO definitions
-#define INPUT(port,pin)			port &= ~(1<<pin)	///< Defines DDR register and pin/bit number as an input
-#define OUTPUT(port,pin)		port |= (1<<pin)	///< Defines DDR register and pin/bit number as an output
-#define SET(port,pin)			port |= (1<<pin)	///< Defines PORT register and set pin/bit number to HIGH
-#define CLEAR(port,pin)			port &= ~(1<<pin)	///< Defines PORT register and set pin/bit number to LOW
-#define TOGGLE(port,pin)		port ^= (1<<pin)	///< Defines PORT register and toggles the bit number
-#define READ(port,pin)			(port & (1<<pin))	///< Defines PINx register and read the pin value at respective bit number. 
-													///< Logical result: "0" if tested pin is "0" and something ">0"if the tested pin is "1".
-													///< The exact return value if tested pin is 1 would depends of the pin number	
-// actually use these for rotary encoder																					
-extern int buttonPressed_delay;
-extern int buttonReleased_delay;
-extern unsigned char buttonPressed;
-
-extern unsigned char read_PINx_digital_level(unsigned char pinport, unsigned char pin);
-extern void debounceDelayInit();
-extern unsigned char checkButton_withMode(unsigned char mode, unsigned char myBUtton_pinport, unsigned char myButton, int buttonDelay);
-
+﻿/*
+ * ports_and_pins.h
+ *
+ * \author Simeon Neykov
+ *
+ */ 
+
+#ifndef PORTS_AND_PINS_H_
+#define PORTS_AND_PINS_H_
+
+#include "hal.h"
+
+enum {
+	whilePressed = 0,
+	onClick = 1,
+};
+
+// AVR MCU's ports and pins MACRO definitions
+#define INPUT(port,pin)			port &= ~(1<<pin)	///< Defines DDR register and pin/bit number as an input
+#define OUTPUT(port,pin)		port |= (1<<pin)	///< Defines DDR register and pin/bit number as an output
+#define SET(port,pin)			port |= (1<<pin)	///< Defines PORT register and set pin/bit number to HIGH
+#define CLEAR(port,pin)			port &= ~(1<<pin)	///< Defines PORT register and set pin/bit number to LOW
+#define TOGGLE(port,pin)		port ^= (1<<pin)	///< Defines PORT register and toggles the bit number
+#define READ(port,pin)			(port & (1<<pin))	///< Defines PINx register and read the pin value at respective bit number. 
+													///< Logical result: "0" if tested pin is "0" and something ">0"if the tested pin is "1".
+													///< The exact return value if tested pin is 1 would depends of the pin number	
+
+/*@{*/
+// compile-time pin descriptors: a signal is defined once as "port letter, pin number" (e.g. #define PIN_LED C, 5 in main.h),
+// the macros below expand it to the registers of its port. Port and pin are constants, no call and no shift is left
+// at run time. SBIS / SBIC for a tested level and SBI / CBI for a write are expected from avr-gcc but not checked yet,
+// see the instructions with make -C ../bench disasm FUNC=rotary_sample before relying on the timing.
+// The macros take '...': the descriptor is already two arguments when it reaches them.
+#define PIN_BIT(...)			PIN_BIT_(__VA_ARGS__)			///< pin number of the signal
+#define PIN_MASK(...)			(1 << PIN_BIT(__VA_ARGS__))		///< bit mask of the signal in its port registers
+#define PIN_INPUTS(...)			PIN_INPUTS_(__VA_ARGS__)		///< input levels of the whole port of the signal (through hal.h)
+#define PIN_LEVEL(...)			PIN_LEVEL_(__VA_ARGS__)			///< input level of the signal, 0 LOW or 1 HIGH
+#define PIN_HIGH(...)			PIN_HIGH_(__VA_ARGS__)			///< output (or pull-up of an input) set HIGH
+#define PIN_LOW(...)			PIN_LOW_(__VA_ARGS__)			///< output (or pull-up of an input) set LOW
+#define PIN_TOGGLE(...)			PIN_TOGGLE_(__VA_ARGS__)		///< output toggled
+#define PIN_OUTPUT(...)			PIN_OUTPUT_(__VA_ARGS__)		///< pin direction output
+#define PIN_INPUT(...)			PIN_INPUT_(__VA_ARGS__)			///< pin direction input
+#define PIN_PULLUP(...)			PIN_PULLUP_(__VA_ARGS__)		///< pin direction input with the pull-up on (idle HIGH)
+
+// second step, the descriptor is split into its port letter and pin number
+#define PIN_BIT_(port, pin)		(pin)
+#define PIN_INPUTS_(port, pin)	HAL_PIN##port()
+#define PIN_LEVEL_(port, pin)	((HAL_PIN##port() & (1 << (pin))) ? 1 : 0)
+#define PIN_HIGH_(port, pin)	(PORT##port |= (1 << (pin)))
+#define PIN_LOW_(port, pin)		(PORT##port &= ~(1 << (pin)))
+#define PIN_TOGGLE_(port, pin)	(PORT##port ^= (1 << (pin)))
+#define PIN_OUTPUT_(port, pin)	(DDR##port |= (1 << (pin)))
+#define PIN_INPUT_(port, pin)	(DDR##port &= ~(1 << (pin)))
+#define PIN_PULLUP_(port, pin)	do { PIN_INPUT_(port, pin); PIN_HIGH_(port, pin); } while (0)
+/*@}*/
+
+#define checkButton(mode, ...)						checkButton_(mode, __VA_ARGS__)		///< checkButton(mode, signal, buttonDelay): push button given by its pin descriptor, see checkButton_withMode()
+#define checkButton_(mode, port, pin, buttonDelay)	checkButton_withMode(mode, PIN_LEVEL_(port, pin), pin, buttonDelay)
+
+extern int buttonPressed_delay;
+extern int buttonReleased_delay;
+extern unsigned char buttonPressed;
+
+extern void debounceDelayInit();
+extern unsigned char checkButton_withMode(unsigned char mode, unsigned char level, unsigned char myButton, int buttonDelay);
+
 #endif /* PORTS_AND_PINS_H_ */
\ No newline at end of file
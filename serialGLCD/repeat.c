@@ -0,0 +1,120 @@
+﻿/** \page pageRepeat Typematic auto-repeat of the buttons
+ * 
+ * ##Timer driven auto-repeat for buttons held down
+ *
+ * repeat.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Timer0 in CTC mode interrupts every 1ms, the interrupt samples the 'up' and 'down' buttons
+ * - a level change is taken when stable for REPEAT_DEBOUNCE_MS
+ * - press gives one event, after REPEAT_DELAY_MS held the events repeat every REPEAT_INTERVAL_MS,
+ *   each repeat shortens the interval by REPEAT_RAMP_MS down to REPEAT_FAST_MS
+ * - events are counted, the main loop takes them with repeat_take(). Events of a slow redraw are not lost,
+ *   they come together and the menu jumps by all of them at once, thus the rate does not depend on the main loop
+ *
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "main.h"
+#include "repeat.h"
+#include "ports_and_pins.h"
+#include "keypad.h"
+
+/** 
+ * State of one key, owned by the Timer0 interrupt except 'events'
+ */
+typedef struct RepeatStructure {
+	/*@{*/
+	unsigned char mask;				/**< pin mask of the key, all keys are on the port of PIN_BUTTON_UP */
+	unsigned char pressed;			/**< debounced state, 1 pressed */
+	unsigned char debounce;			/**< ms the raw level differs from the debounced state */
+	unsigned int next;				/**< ms left to the next repeat while pressed */
+	unsigned int interval;			/**< current repeat interval in ms */
+	volatile unsigned char events;	/**< events not taken yet by repeat_take(), saturated at 255 */
+	/*@}*/
+}RepeatKey;
+
+static RepeatKey repeat_keys[REPEAT_KEYS] = {
+	{ PIN_MASK(PIN_BUTTON_UP), 0, 0, 0, 0, 0 },
+	{ PIN_MASK(PIN_BUTTON_DOWN), 0, 0, 0, 0, 0 },
+};
+
+/** ##Auto-repeat - one event of a key
+ */
+static void repeat_event(RepeatKey *key)
+{
+	if (key->events != 255) key->events++;
+}
+
+/** ##Timer0 compare interrupt - 1ms key sampling and repeat timing
+ *
+ * One row of the key matrix is scanned as well, see keypad.c.
+ */
+ISR(TIMER0_COMPA_vect)
+{
+	unsigned char port = PIN_INPUTS(PIN_BUTTON_UP);		// one read for both keys, both are on port C
+	RepeatKey *key;
+	
+	for (key = repeat_keys; key < repeat_keys + REPEAT_KEYS; key++)
+	{
+		unsigned char level = ((port & key->mask) == 0);		// active low
+		
+		if (level != key->pressed)
+		{
+			if (++key->debounce < REPEAT_DEBOUNCE_MS) continue;
+			key->debounce = 0;
+			key->pressed = level;
+			if (level)
+			{
+				repeat_event(key);
+				key->next = REPEAT_DELAY_MS;
+				key->interval = REPEAT_INTERVAL_MS;
+			}
+			continue;
+		}
+		key->debounce = 0;
+		if (!key->pressed || --key->next) continue;
+		
+		repeat_event(key);
+		key->next = key->interval;
+		if (key->interval >= REPEAT_FAST_MS + REPEAT_RAMP_MS) key->interval -= REPEAT_RAMP_MS;
+		else key->interval = REPEAT_FAST_MS;
+	}
+#if (KEYPAD_ENABLE == TRUE)
+	keypad_scan();
+#endif
+}
+
+/** ##Auto-repeat initialization
+ * 
+ * Timer0 CTC mode, prescaler 64, 250 counts, thus 1ms at F_CPU 16MHz. Compare interrupt enabled.
+ * Consider global interrupts are to be enabled (sei) afterwards.
+ *
+ */
+void repeat_init(void)
+{
+	TCCR0A = (1 << WGM01);					// CTC, TOP = OCR0A
+	TCCR0B = (1 << CS01) | (1 << CS00);		// clk/64
+	OCR0A = (F_CPU / 64 / 1000) - 1;
+	TIMSK0 |= (1 << OCIE0A);
+}
+
+/** ##Auto-repeat - take the events of a key
+ *
+ * @param key REPEAT_KEY_UP or REPEAT_KEY_DOWN
+ * @return number of press and repeat events since the previous call, 0 if none
+ *
+ */
+unsigned char repeat_take(unsigned char key)
+{
+	unsigned char sreg = SREG;
+	unsigned char events;
+	
+	cli();
+	events = repeat_keys[key].events;
+	repeat_keys[key].events = 0;
+	SREG = sreg;
+	return events;
+}
@@ -0,0 +1,24 @@
+﻿/*
+ * repeat.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef REPEAT_H_
+#define REPEAT_H_
+
+#include "main.h"
+
+/** 
+ * Keys with typematic auto-repeat, see repeat_take()
+ */
+enum {
+	REPEAT_KEY_UP = 0,							///< button 'up'
+	REPEAT_KEY_DOWN = 1,						///< button 'down'
+	REPEAT_KEYS
+};
+
+void repeat_init(void);
+unsigned char repeat_take(unsigned char key);
+
+#endif /* REPEAT_H_ */
@@ -0,0 +1,156 @@
+﻿/** \page pageRotary Rotary encoder with velocity based acceleration
+ * 
+ * ##Rotary encoder handler - debouncing, direction and acceleration
+ *
+ * rotary.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - ROTARY_CK (clock) is sampled until ROTARY_DELAY equal readings in a row (debouncing), ROTARY_DA (data) is taken with it
+ * - every change of the debounced clock level is one detent, CK and DA in the same state is 'up' (-1), else 'down' (+1)
+ * - acceleration: the time since the previous detent selects the step of this detent (see ROTARY_ACCEL_* in main.h)
+ *		- slow turn moves by one, moderate turn by ROTARY_ACCEL_SLOW_STEP, fast spin by ROTARY_ACCEL_FAST_STEP,
+ *		  very fast by ROTARY_ACCEL_TURBO_STEP
+ *		- the step is limited to 1/ROTARY_ACCEL_SHARE of the range the caller moves through (menu section, list,
+ *		  parameter), thus short menus are not skipped through while long lists and wide parameters still accelerate
+ * - a fast spin is collected into one jump: detents are summed while they come within ROTARY_COALESCE_MS,
+ *   thus the caller redraws once per spin instead of once per detent. A single detent is reported ROTARY_COALESCE_MS later
+ * - the time the first detent of a move was seen is kept for the latency instrumentation, see rotary_eventTicks()
+ * - the reference clock level is kept here and changed by detents only, call rotary_sync() after long blocking work
+ *   (e.g. redraw), when the edges could not be followed
+ *
+ */
+
+#include "main.h"			// first, F_CPU is defined here for <util/delay.h>
+#include <avr/io.h>
+#include <util/delay.h>
+#include "rotary.h"
+#include "timer.h"
+#include "ports_and_pins.h"
+
+
+static unsigned char rotary_lastCK = 1;			///< debounced clock level of the last detent
+static unsigned long rotary_lastDetent = 0;		///< time of the last detent in ms
+static unsigned long rotary_sampleStart = 0;	///< time the last sampling started, timer ticks
+static unsigned long rotary_firstTicks = 0;		///< time the first detent of the last move was seen, timer ticks
+
+/** ##Rotary encoder - debounced clock level
+ *
+ * @param data data level taken together with the stable clock
+ * @return clock level
+ *
+ */
+static unsigned char rotary_sample(unsigned char *data)
+{
+	unsigned char stable = ROTARY_DELAY;
+	unsigned char level = PIN_LEVEL(PIN_ROTARY_CLK);
+	unsigned char now;
+	
+	rotary_sampleStart = timer_ticks();
+	while (stable)
+	{
+		_delay_us(ROTARY_SAMPLE_US);
+		now = PIN_LEVEL(PIN_ROTARY_CLK);
+		if (now == level)
+		{
+			stable--;
+			*data = PIN_LEVEL(PIN_ROTARY_DATA);
+		} else {
+			level = now;
+			stable = ROTARY_DELAY;
+		}
+	}
+	return level;
+}
+
+/** ##Rotary encoder - one detent without acceleration
+ *
+ * @return -1 up, 1 down, 0 no move
+ *
+ */
+static signed char rotary_detent(void)
+{
+	unsigned char data = 0;
+	unsigned char clock = rotary_sample(&data);
+	
+	if (clock == rotary_lastCK) return 0;
+	rotary_lastCK = clock;
+	return (clock == data) ? -1 : 1;
+}
+
+/** ##Rotary encoder - step of a detent given the time since the previous one
+ */
+static unsigned char rotary_multiplier(unsigned long since, unsigned int range)
+{
+	unsigned char step = 1;
+	
+#if (ROTARY_ACCEL == TRUE)
+	if (since < ROTARY_ACCEL_TURBO_MS) step = ROTARY_ACCEL_TURBO_STEP;
+	else if (since < ROTARY_ACCEL_FAST_MS) step = ROTARY_ACCEL_FAST_STEP;
+	else if (since < ROTARY_ACCEL_SLOW_MS) step = ROTARY_ACCEL_SLOW_STEP;
+	range /= ROTARY_ACCEL_SHARE;
+	if (step > range) step = range ? range : 1;
+#endif
+	return step;
+}
+
+/** ##Rotary encoder - take the debounced clock level as the reference
+ *
+ * Edges which happened meanwhile are dropped, thus a blocking redraw does not cause a false detent.
+ *
+ */
+void rotary_sync(void)
+{
+	unsigned char data;
+	
+	rotary_lastCK = rotary_sample(&data);
+}
+
+/** ##Rotary encoder - poll for a move
+ *
+ * Takes about ROTARY_DELAY * ROTARY_SAMPLE_US if the encoder is at rest.
+ * After a detent the polling continues until the encoder rests for ROTARY_COALESCE_MS, 
+ * all detents are summed with their acceleration.
+ * @param range Number of places the steps move through (e.g. menu_length(), parameter max - min + 1), limits
+ *				the acceleration. ROTARY_RANGE_ANY if not known
+ * @return steps to move, negative up, positive down, 0 no move
+ *
+ */
+int rotary_poll(unsigned int range)
+{
+	signed char direction = rotary_detent();
+	unsigned long now;
+	unsigned long since;
+	int steps;
+	
+	if (!direction) return 0;
+	rotary_firstTicks = rotary_sampleStart;
+	now = timer_millis();
+	since = now - rotary_lastDetent;
+	rotary_lastDetent = now;
+	steps = direction * rotary_multiplier(since, range);
+	
+	// the caller redraws next and cannot follow the encoder meanwhile, wait for the rest of a spin first
+	while ((timer_millis() - rotary_lastDetent) < ROTARY_COALESCE_MS)
+	{
+		direction = rotary_detent();
+		if (!direction) continue;
+		now = timer_millis();
+		since = now - rotary_lastDetent;
+		rotary_lastDetent = now;
+		steps += direction * rotary_multiplier(since, range);
+		if (steps > ROTARY_STEPS_MAX) steps = ROTARY_STEPS_MAX;
+		if (steps < -ROTARY_STEPS_MAX) steps = -ROTARY_STEPS_MAX;
+	}
+	return steps;
+}
+
+/** ##Rotary encoder - time of the last move
+ *
+ * @return time the first detent of the steps last returned by rotary_poll() was seen, before its debouncing, timer ticks
+ *
+ */
+unsigned long rotary_eventTicks(void)
+{
+	return rotary_firstTicks;
+}
@@ -0,0 +1,21 @@
+﻿/*
+ * rotary.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef ROTARY_H_
+#define ROTARY_H_
+
+#include "main.h"
+
+/*@{*/
+#define ROTARY_STEPS_MAX		1000			///< limit of the steps collected into one jump
+#define ROTARY_RANGE_ANY		0xFFFF			///< range of rotary_poll(): not known or not limited, full acceleration
+/*@}*/
+
+void rotary_sync(void);
+int rotary_poll(unsigned int range);
+unsigned long rotary_eventTicks(void);
+
+#endif /* ROTARY_H_ */
@@ -1,248 +1,667 @@
-﻿/** \page pageLCD Serial GLCD ADM12864H
- *
- * ##Utilize ASCII commands and base functions for a serial graphic LCD ADM12864H
- *
- * serialGLCD.c
- *
- * \author Simeon Neykov
- * 
- * [Used demos] (https://www.avrfreaks.net/forum/tut-c-bit-manipulation-aka-programming-101?name=PNphpBB2&file=viewtopic&t=37871)
- *
- * [SparkFun items] (https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- */
-
-#include <avr/io.h>
-#include "main.h"
-#include "USART.h"
-#include "serialGLCD.h"
-#include <util/delay.h>
-
-/** ##Serial ASCII commands - backlight duty cycle.
- * 
- * Set back light Duty Cycle.
- *
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * Consider UART was initialized and enabled.
- * Setting the value to zero turns the back light off, setting it at 100 or above turns it full on.
- * Intermediate values set it somewhere in- between.
- *
- */
-void serialGLCD_backlight(unsigned char backlight)
-{
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x7C;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x02;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = backlight;
-}
-
-/** ##Serial ASCII commands - toggle reverse display mode.
- * 
- * Toggle reverse display mode.
- *
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * Consider UART was initialized and enabled.
- * Setting the reverse mode causes the screen to immediately clear with the new background.
- * If the display is turned off while in reverse mode, it will next power up in reverse mode.
- *
- */
-void serialGLCD_reverse()
-{
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x7C;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x12;
-}
-
-/** ##Serial ASCII commands - Clear Screen.
- * 
- * This command clears the screen of all written pixels.
- *
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * Consider UART was initialized and enabled.
- * If you're operating in normal mode, all pixels are reset.
- * If you're operating in reverse mode, all pixels are set.
- *
- */
-void serialGLCD_clear()
-{
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x7C;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x00;
-	_delay_ms(1);
-}
-
-/** ##Serial GLCD - Send an ASCII Character.
- * 
- * This command send a character to GLCD
- *
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * - Consider UART was initialized and enabled.
- * - Consider needed X, Y coordinates have been set before.
- * - Character is being displayed at current X, Y position and it is moved forward to next position, thus the display is acting like the known type character LCD.
- * - Consider needed time for the backpack's microcontroller on LCD module to do its stuffs.
- * - Initially used added delay in _sendChar function but finally moved it into wait_while_UART0_is_busy();
- * - Consider 5ms should be sufficient delay but could depends of the complexity of the screen we want to show
- *
- */
-void serialGLCD_sendChar(unsigned char myChar)
-{
-	wait_while_UART0_is_busy(GLCD_DELAY); // check if the transmitter is busy
-	UDR0 = myChar;
-}
-
-/** ##Serial GLCD - Send A String of Characters.
- * 
- * This command send a string of characters to GLCD
- *
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * - Consider UART was initialized and enabled.
- * - Consider needed X, Y coordinates have been set before.
- * - First character of the string is being displayed at current X, Y position and it is moved forward to next position.
- * - Thus the display is acting like the known type character LCD
- *
- */
-void serialGLCD_sendString(char *myString)
-{
-	while (*myString > 0)
-	{
-		serialGLCD_sendChar(*myString++);
-	}	
-}
-
-/** ##Serial ASCII commands - Set X and Y pixel coordinates.
- * 
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * Consider UART was initialized and enabled.
- *
- * Coordinates are indexed from 0, 0 - upper left corner of the display.
- * SparkFun Graphic LCD Serial Backpack has embedded firmware with character generator.
- * The X and Y reference coordinates are used by the text generator to place text at specific locations on the screen.
- * The coordinates refer to the upper left most pixel in the character space. 
- *
- * If the offsets are within 6 pixels of the right edge of the screen or 8 pixels of the bottom, 
- * the text generator will revert to the next logical line for text so as to print a whole character and not parts.
- *
- * @param pixelX	range 0, 127
- * @param pixelY	range 0, 63
- *
- */
-void serialGLCD_gotoPixel_XY(unsigned char pixelX, unsigned char pixelY)
-{
-	// check the range
-	if (pixelX > INITIAL_pixel_MAXX) pixelX = 0;
-	if (pixelY > INITIAL_pixel_MAXY) pixelY = 0;
-	// send X
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x7C;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x18;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = pixelX;
-	
-	// send Y
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x7C;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x19;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = pixelY;	
-	_delay_ms(1);
-}
-
-/** ##Serial ASCII commands - Set refX and refY Coordinates referred to 21x8 display format.
- * 
- * Coordinate transformation is valid for 128x64 pixels display and 6x8 character format.
- *
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * Consider UART was initialized and enabled.
- * - Details:
- *		- 21x8 format emulates  character display with 21 symbols on 8 rows
- *		- Coordinates are indexed from 0, 0
- *		- Coordinates are referred to 6x8 pixels sized characters
- * @param refX		range 0, 20
- * @param refY		range 0, 7
- * 
- * Note: These ranges are valid for 128x64 type display. These should be aligned for a different type / format LCD display.
- */
-void serialGLCD_goto21x8_XY(unsigned char refX, unsigned char refY)
-{
-	// find pixel X
-	unsigned char pixelX = (refX) * 6; ///< pixelX	range 0, 127
-	// find pixel Y
-	unsigned char pixelY = (refY) * 8; ///< pixelY	range 0, 63
-	
-	// goto pixel X, Y
-	serialGLCD_gotoPixel_XY(pixelX, pixelY);
-}
-
-/** ##Serial GLCD - Send A String of Characters.
- * 
- * This command send a string of characters to GLCD
- *
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * - Consider UART was initialized and enabled.
- * - Consider needed X, Y coordinates have been set before.
- * - First character of the string is being displayed at current X, Y position.
- *
- * @param refX, refY Coordinates indexed from 0 !!
- * @param *myString Points to the elements of the string to be sent to LCD
- *
- */
-void serialGLCD_sendString_at_21x8(unsigned char refX, unsigned char refY, char *myString)
-{
-	serialGLCD_goto21x8_XY(refX, refY);
-	while (*myString > 0)
-	{
-		serialGLCD_sendChar(*myString++);
-	}
-	
-}
-
-/** ##Serial ASCII commands - drawBox.
- * 
- * Set X and Y referred to the Pixel level coordinates
- *
- * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
- *
- * Consider UART was initialized and enabled.
- *
- * Sending hex value 0x0F followed by two sets of (x, y) coordinates defining opposite corners of the box, 
- * followed by a 0 or 1 determines whether to draw or erase the box. This command is exactly like the draw line command, 
- * but instead of drawing a line you get a box that exactly contains the line between the given coordinates.
- *
- * Coordinates are indexed from 0, 0 referred to the upper left corner of the display.
- * @param TopLeftX, TopLeftY Coordinates of the upper left corner of the box.
- * @param BottomRightX, BottomRightY Coordinates of the upper left corner of the box.
- * @param draw Defines whether we draw the box or erase the box
- *
- */
-void serialGLCD_drawBox(unsigned char TopLeftX, unsigned char TopLeftY, unsigned char BottomRightX, unsigned char BottomRightY, unsigned char draw)
-{
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x7C;				// send command identificator 0x7C (tells Sparkfun's backpack MCU the next data on RxD will be command.
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = 0x0F;				// send drawBox actual command identificator
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = TopLeftX;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = TopLeftY;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = BottomRightX;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = BottomRightY;
-	wait_while_UART0_is_busy(0); // check if the transmitter is busy
-	UDR0 = draw;
-	_delay_ms(5);	
-}
+﻿/** \page pageLCD Serial GLCD ADM12864H
+ *
+ * ##Utilize ASCII commands and base functions for a serial graphic LCD ADM12864H
+ *
+ * serialGLCD.c
+ *
+ * \author Simeon Neykov
+ * 
+ * [Used demos] (https://www.avrfreaks.net/forum/tut-c-bit-manipulation-aka-programming-101?name=PNphpBB2&file=viewtopic&t=37871)
+ *
+ * [SparkFun items] (https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * ##Display handles
+ * - Each display (panel) is represented by a GLCD_Display handle: transport functions, own transmit queue and shadow state
+ * - serialGLCD_* functions write to the active display, selected with serialGLCD_select()
+ * - Bytes are queued per display together with the pacing delay the backpack needs after the byte
+ * - serialGLCD_service() sends one byte to each display whose transport is ready and whose pacing time is over.
+ *   Pacing is kept per display as a time stamp (see timer.c), serialGLCD_service() never waits.
+ *   Thus two panels refresh in parallel, each with its own backpack pacing
+ * - serialGLCD_put() serves the queues once after queuing, thus the first byte goes out on the wire immediately
+ * - Default display 'serialGLCD_main' is UART0, it is registered and active without any call
+ *
+ * ##Command stream
+ * - serialGLCD_* functions build a command (GLCD_Command), serialGLCD_model() follows its effect on the shadow state
+ *   of the display (cursor, backlight, reverse mode, blank screen), serialGLCD_encode() queues its bytes
+ * - Peephole stage (GLCD_PEEPHOLE): commands are held back in a window of GLCD_PEEPHOLE_WINDOW per display, 
+ *   a command with the same net effect as a shorter sequence is dropped, merged or replaced before it is encoded:
+ *		- goto to where the cursor is already (e.g. next row after a full row, the text generator wraps) is dropped
+ *		- goto directly after a goto replaces it
+ *		- backlight with the current duty cycle is dropped, a pending one takes the new value
+ *		- clear drops the drawing pending since the last clear / reverse, clear of a blank screen is a goto 0, 0 at most
+ *		- reverse twice is a clear
+ *		- box / line right after the same box / line replaces it (draw then erase), erase on a blank screen is dropped
+ * - The window is encoded when full (the oldest command), by serialGLCD_service() and serialGLCD_flush(),
+ *   thus the held back commands wait at most until the main loop is idle again
+ *
+ */
+
+#include <avr/io.h>
+#include "main.h"
+#include "USART.h"
+#include "serialGLCD.h"
+#include "timer.h"
+#include "trace.h"
+#include <string.h>
+#include <util/delay.h>
+
+static unsigned char serialGLCD_uart0Ready(void);
+static void serialGLCD_uart0Transmit(unsigned char data);
+
+GLCD_Display serialGLCD_main = { .ready = serialGLCD_uart0Ready, .transmit = serialGLCD_uart0Transmit, 
+	.pixelX = GLCD_UNKNOWN, .pixelY = GLCD_UNKNOWN, .backlight = GLCD_UNKNOWN };	///< panel on UART0, default active display
+GLCD_Display *serialGLCD_displays = &serialGLCD_main;		///< list of registered displays, served by serialGLCD_service()
+GLCD_Display *serialGLCD_active = &serialGLCD_main;			///< display written by serialGLCD_* functions
+
+volatile unsigned char serialGLCD_probe = 0;		///< latency instrumentation: set to 1 to capture time stamp of the next transmitted byte
+unsigned long serialGLCD_probeTick = 0;				///< latency instrumentation: time stamp (timer ticks) of the captured byte
+
+/** ##UART0 transport - ready to accept next byte
+ */
+static unsigned char serialGLCD_uart0Ready(void)
+{
+	return HAL_UART0_READY() ? 1 : 0;
+}
+
+/** ##UART0 transport - load the transmit buffer
+ */
+static void serialGLCD_uart0Transmit(unsigned char data)
+{
+	HAL_UART0_WRITE(data);
+}
+
+/** ##Display handle - register a display
+ * 
+ * Registered displays are served by serialGLCD_service(). The display is not selected, see serialGLCD_select().
+ * @param display Handle to be initialized, must stay valid (static or global)
+ * @param ready Function returning non zero if the transport can accept next byte
+ * @param transmit Function putting one byte on the transport
+ *
+ */
+void serialGLCD_register(GLCD_Display *display, unsigned char (*ready)(void), void (*transmit)(unsigned char data))
+{
+	GLCD_Display *item;
+	
+	display->ready = ready;
+	display->transmit = transmit;
+	display->head = 0;
+	display->tail = 0;
+	display->pixelX = GLCD_UNKNOWN;
+	display->pixelY = GLCD_UNKNOWN;
+	display->backlight = GLCD_UNKNOWN;
+	display->reverse = 0;
+	display->blank = 0;
+#if (GLCD_PEEPHOLE == TRUE)
+	display->pending = 0;
+#endif
+	display->holdUntil = timer_ticks();
+	
+	for (item = serialGLCD_displays; item; item = item->next)
+	{
+		if (item == display) return;	// already in the list
+	}
+	display->next = serialGLCD_displays;
+	serialGLCD_displays = display;
+}
+
+/** ##Display handle - select the display written by serialGLCD_* functions
+ */
+void serialGLCD_select(GLCD_Display *display)
+{
+	serialGLCD_active = display;
+}
+
+/** ##Display handle - serve transmit queues of all registered displays, one round
+ *
+ * - one byte is sent to each display with a non empty queue, ready transport and pacing time over
+ * - pacing delay of the sent byte is stored as the display's hold time stamp, nothing waits here
+ * - Consider timer_init() was called, pacing is based on the Timer1 time base
+ * @return non zero if any queue is still not empty
+ *
+ */
+static unsigned char serialGLCD_serve(void)
+{
+	GLCD_Display *display;
+	unsigned char pending = 0;
+	unsigned long now = timer_ticks();
+	
+	for (display = serialGLCD_displays; display; display = display->next)
+	{
+		if (display->head == display->tail) continue;
+		if (((long)(now - display->holdUntil) >= 0) && display->ready())
+		{
+			display->transmit(display->queue[display->tail]);
+			display->holdUntil = now + (unsigned long)display->pace[display->tail] * TIMER_TICKS_PER_MS;
+			display->tail = (display->tail + 1) & (GLCD_QUEUE_SIZE - 1);
+			if (serialGLCD_probe)
+			{
+				serialGLCD_probeTick = now;
+				serialGLCD_probe = 0;
+			}
+			if ((display == &serialGLCD_main) && (display->head == display->tail)) TRACE(TRACE_UART_IDLE, 0);
+		}
+		if (display->head != display->tail) pending = 1;
+	}
+	return pending;
+}
+
+/** ##Display handle - queue a byte for a display
+ *
+ * If the queue is full, queues of all displays are served until there is a free place.
+ * Queues are served once afterwards, thus a byte queued to an idle display is transmitted immediately.
+ *
+ */
+static void serialGLCD_putTo(GLCD_Display *display, unsigned char data, unsigned char pace)
+{
+	unsigned char head = (display->head + 1) & (GLCD_QUEUE_SIZE - 1);
+	
+	while (head == display->tail) serialGLCD_serve();
+	display->queue[display->head] = data;
+	display->pace[display->head] = pace;
+	display->head = head;
+	serialGLCD_serve();
+}
+
+/** ##Command stream - follow the effect of a command on the shadow state
+ */
+static void serialGLCD_model(GLCD_Display *display, const GLCD_Command *command)
+{
+	switch (command->op)
+	{
+		case GLCD_OP_CHAR:
+			// text generator goes to the next line when within 6 pixels of the right edge
+			display->pixelX += GLCD_CHAR_WIDTH;
+			if (display->pixelX > INITIAL_pixel_MAXX - (GLCD_CHAR_WIDTH - 1))
+			{
+				display->pixelX = 0;
+				display->pixelY += GLCD_CHAR_HEIGHT;
+				if (display->pixelY > INITIAL_pixel_MAXY - (GLCD_CHAR_HEIGHT - 1)) display->pixelY = 0;
+			}
+			if (command->arg[0] != ' ') display->blank = 0;
+			break;
+		case GLCD_OP_GOTO:
+			display->pixelX = command->arg[0];
+			display->pixelY = command->arg[1];
+			break;
+		case GLCD_OP_REVERSE:
+			display->reverse ^= 1;
+			// no break, the screen is cleared as well
+		case GLCD_OP_CLEAR:
+			display->pixelX = 0;
+			display->pixelY = 0;
+			display->blank = 1;
+			break;
+		case GLCD_OP_BACKLIGHT:
+			display->backlight = command->arg[0];
+			break;
+		default:
+			if (command->arg[4]) display->blank = 0;
+			break;
+	}
+}
+
+/** ##Command stream - queue the bytes of a command
+ *
+ * Pacing: 1ms after the coordinates and the clear, GLCD_DELAY after a character, 5ms after a box.
+ *
+ */
+static void serialGLCD_encode(GLCD_Display *display, const GLCD_Command *command)
+{
+	static const unsigned char code[] = { 0, 0, 0x00, 0x02, 0x12, 0x0F, 0x0C };	// indexed by GLCD_OP_*
+	unsigned char i;
+	
+	switch (command->op)
+	{
+		case GLCD_OP_CHAR:
+			serialGLCD_putTo(display, command->arg[0], GLCD_DELAY);
+			break;
+		case GLCD_OP_GOTO:
+			serialGLCD_putTo(display, 0x7C, 0);
+			serialGLCD_putTo(display, 0x18, 0);
+			serialGLCD_putTo(display, command->arg[0], 0);
+			serialGLCD_putTo(display, 0x7C, 0);
+			serialGLCD_putTo(display, 0x19, 0);
+			serialGLCD_putTo(display, command->arg[1], 1);
+			break;
+		case GLCD_OP_CLEAR:
+			serialGLCD_putTo(display, 0x7C, 0);
+			serialGLCD_putTo(display, 0x00, 1);
+			break;
+		case GLCD_OP_BACKLIGHT:
+			serialGLCD_putTo(display, 0x7C, 0);
+			serialGLCD_putTo(display, 0x02, 0);
+			serialGLCD_putTo(display, command->arg[0], 0);
+			break;
+		case GLCD_OP_REVERSE:
+			serialGLCD_putTo(display, 0x7C, 0);
+			serialGLCD_putTo(display, 0x12, 0);
+			break;
+		default:
+			serialGLCD_putTo(display, 0x7C, 0);					// command identificator
+			serialGLCD_putTo(display, code[command->op], 0);	// drawBox / drawLine actual command identificator
+			for (i = 0; i < 4; i++) serialGLCD_putTo(display, command->arg[i], 0);
+			serialGLCD_putTo(display, command->arg[4], (command->op == GLCD_OP_BOX) ? 5 : 1);
+			break;
+	}
+}
+
+#if (GLCD_PEEPHOLE == TRUE)
+/** ##Peephole - encode the oldest held back commands
+ *
+ * @param count Number of commands to be encoded, GLCD_PEEPHOLE_WINDOW (or more) for all
+ *
+ */
+static void serialGLCD_commit(GLCD_Display *display, unsigned char count)
+{
+	unsigned char i;
+	
+	if (count > display->pending) count = display->pending;
+	for (i = 0; i < count; i++) serialGLCD_encode(display, &display->window[i]);
+	for (i = count; i < display->pending; i++) display->window[i - count] = display->window[i];
+	display->pending -= count;
+}
+
+/** ##Peephole - drop the held back drawing erased by a clear
+ *
+ * Characters, gotos, clears, boxes and lines after the last held back reverse are dropped, backlight commands kept.
+ *
+ */
+static void serialGLCD_dropDrawing(GLCD_Display *display)
+{
+	unsigned char from = display->pending;
+	unsigned char i;
+	unsigned char kept;
+	
+	while (from && (display->window[from - 1].op != GLCD_OP_REVERSE)) from--;
+	for (i = kept = from; i < display->pending; i++)
+	{
+		if (display->window[i].op == GLCD_OP_BACKLIGHT) display->window[kept++] = display->window[i];
+	}
+	display->pending = kept;
+}
+
+/** ##Peephole - apply the rules to a new command
+ *
+ * Decisions are based on the shadow state, i.e. the state after all previous commands, held back or not.
+ * The command could be changed to a shorter one with the same net effect.
+ * @return 1 if the command is absorbed (dropped or merged into a held back one), 0 if it is to be held back
+ *
+ */
+static unsigned char serialGLCD_peephole(GLCD_Display *display, GLCD_Command *command)
+{
+	GLCD_Command *last = display->pending ? &display->window[display->pending - 1] : 0;
+	unsigned char i;
+	
+	switch (command->op)
+	{
+		case GLCD_OP_GOTO:
+			if ((command->arg[0] == display->pixelX) && (command->arg[1] == display->pixelY)) return 1;
+			if (last && (last->op == GLCD_OP_GOTO))
+			{
+				*last = *command;
+				return 1;
+			}
+			return 0;
+		case GLCD_OP_BACKLIGHT:
+			if (command->arg[0] == display->backlight) return 1;
+			for (i = 0; i < display->pending; i++)
+			{
+				// independent of the drawing, the pending one takes the new value
+				if (display->window[i].op == GLCD_OP_BACKLIGHT)
+				{
+					display->window[i].arg[0] = command->arg[0];
+					return 1;
+				}
+			}
+			return 0;
+		case GLCD_OP_CLEAR:
+			if (display->blank)
+			{
+				// nothing to clear, only the cursor goes home
+				command->op = GLCD_OP_GOTO;
+				command->arg[0] = 0;
+				command->arg[1] = 0;
+				return serialGLCD_peephole(display, command);
+			}
+			serialGLCD_dropDrawing(display);
+			// a held back reverse clears the screen already
+			return (display->pending && (display->window[display->pending - 1].op == GLCD_OP_REVERSE));
+		case GLCD_OP_REVERSE:
+			serialGLCD_dropDrawing(display);
+			if (display->pending && (display->window[display->pending - 1].op == GLCD_OP_REVERSE))
+			{
+				// reverse twice is a clear, the mode stays
+				display->pending--;
+				display->reverse ^= 1;
+				serialGLCD_dropDrawing(display);
+				command->op = GLCD_OP_CLEAR;
+			}
+			return 0;
+		case GLCD_OP_BOX:
+		case GLCD_OP_LINE:
+			if (!command->arg[4] && display->blank && !display->reverse) return 1;
+			if (last && (last->op == command->op) && !memcmp(last->arg, command->arg, 4))
+			{
+				last->arg[4] = command->arg[4];
+				return 1;
+			}
+			return 0;
+		default:
+			return 0;
+	}
+}
+#endif
+
+/** ##Command stream - send a command to the active display
+ *
+ * With GLCD_PEEPHOLE the command is held back (or absorbed), otherwise queued right away.
+ *
+ */
+static void serialGLCD_emit(GLCD_Command *command)
+{
+	GLCD_Display *display = serialGLCD_active;
+	
+#if (GLCD_PEEPHOLE == TRUE)
+	if (!serialGLCD_peephole(display, command))
+	{
+		if (display->pending == GLCD_PEEPHOLE_WINDOW) serialGLCD_commit(display, 1);
+		display->window[display->pending++] = *command;
+	}
+#else
+	serialGLCD_encode(display, command);
+#endif
+	serialGLCD_model(display, command);
+}
+
+/** ##Display handle - serve all registered displays, one round
+ *
+ * Held back commands (GLCD_PEEPHOLE) are encoded first, then one byte is sent to each display, see serialGLCD_serve().
+ * To be called from the main loop while idle.
+ * @return non zero if any queue is still not empty
+ *
+ */
+unsigned char serialGLCD_service(void)
+{
+#if (GLCD_PEEPHOLE == TRUE)
+	GLCD_Display *display;
+	
+	for (display = serialGLCD_displays; display; display = display->next)
+	{
+		if (display->pending) serialGLCD_commit(display, GLCD_PEEPHOLE_WINDOW);
+	}
+#endif
+	return serialGLCD_serve();
+}
+
+/** ##Display handle - send everything queued for all registered displays
+ */
+void serialGLCD_flush(void)
+{
+	while (serialGLCD_service());
+}
+
+/** ##Display handle - check for queued output
+ *
+ * @return non zero if any registered display has bytes still queued (or commands held back)
+ *
+ */
+unsigned char serialGLCD_busy(void)
+{
+	GLCD_Display *display;
+	
+	for (display = serialGLCD_displays; display; display = display->next)
+	{
+		if (display->head != display->tail) return 1;
+#if (GLCD_PEEPHOLE == TRUE)
+		if (display->pending) return 1;
+#endif
+	}
+	return 0;
+}
+
+/** ##Display handle - queue a byte for the active display
+ *
+ * Raw byte, not a backpack command (e.g. trace records). Commands held back for the display are queued first.
+ * If the queue is full, queues of all displays are served until there is a free place.
+ * Queues are served once afterwards, thus a byte queued to an idle display is transmitted immediately.
+ * @param data Byte to be sent
+ * @param pace Delay in ms the backpack needs after this byte (e.g. GLCD_DELAY after a character)
+ *
+ */
+void serialGLCD_put(unsigned char data, unsigned char pace)
+{
+#if (GLCD_PEEPHOLE == TRUE)
+	serialGLCD_commit(serialGLCD_active, GLCD_PEEPHOLE_WINDOW);
+#endif
+	serialGLCD_putTo(serialGLCD_active, data, pace);
+}
+
+/** ##Serial ASCII commands - backlight duty cycle.
+ * 
+ * Set back light Duty Cycle.
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * Consider UART was initialized and enabled.
+ * Setting the value to zero turns the back light off, setting it at 100 or above turns it full on.
+ * Intermediate values set it somewhere in- between.
+ *
+ */
+void serialGLCD_backlight(unsigned char backlight)
+{
+	GLCD_Command command = { GLCD_OP_BACKLIGHT, { (backlight > 100) ? 100 : backlight } };	// above 100 is full on as well
+	
+	serialGLCD_emit(&command);
+}
+
+/** ##Serial ASCII commands - toggle reverse display mode.
+ * 
+ * Toggle reverse display mode.
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * Consider UART was initialized and enabled.
+ * Setting the reverse mode causes the screen to immediately clear with the new background.
+ * If the display is turned off while in reverse mode, it will next power up in reverse mode.
+ *
+ */
+void serialGLCD_reverse()
+{
+	GLCD_Command command = { GLCD_OP_REVERSE };
+	
+	serialGLCD_emit(&command);
+}
+
+/** ##Serial ASCII commands - Clear Screen.
+ * 
+ * This command clears the screen of all written pixels.
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * Consider UART was initialized and enabled.
+ * If you're operating in normal mode, all pixels are reset.
+ * If you're operating in reverse mode, all pixels are set.
+ *
+ */
+void serialGLCD_clear()
+{
+	GLCD_Command command = { GLCD_OP_CLEAR };
+	
+	serialGLCD_emit(&command);
+}
+
+/** ##Serial GLCD - Send an ASCII Character.
+ * 
+ * This command send a character to GLCD
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * - Consider UART was initialized and enabled.
+ * - Consider needed X, Y coordinates have been set before.
+ * - Character is being displayed at current X, Y position and it is moved forward to next position, thus the display is acting like the known type character LCD.
+ * - Consider needed time for the backpack's microcontroller on LCD module to do its stuffs.
+ * - Initially used added delay in _sendChar function, then in wait_while_UART0_is_busy(), now it is queued as the pacing of the character byte
+ * - Consider 5ms should be sufficient delay but could depends of the complexity of the screen we want to show
+ * - Shadow cursor position follows the backpack's text generator (next line when within 6 pixels of the right edge)
+ *
+ */
+void serialGLCD_sendChar(unsigned char myChar)
+{
+	GLCD_Command command = { GLCD_OP_CHAR, { myChar } };
+	
+	serialGLCD_emit(&command);
+}
+
+/** ##Serial GLCD - Send A String of Characters.
+ * 
+ * This command send a string of characters to GLCD
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * - Consider UART was initialized and enabled.
+ * - Consider needed X, Y coordinates have been set before.
+ * - First character of the string is being displayed at current X, Y position and it is moved forward to next position.
+ * - Thus the display is acting like the known type character LCD
+ *
+ */
+void serialGLCD_sendString(char *myString)
+{
+	while (*myString > 0)
+	{
+		serialGLCD_sendChar(*myString++);
+	}	
+}
+
+/** ##Serial ASCII commands - Set X and Y pixel coordinates.
+ * 
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * Consider UART was initialized and enabled.
+ *
+ * Coordinates are indexed from 0, 0 - upper left corner of the display.
+ * SparkFun Graphic LCD Serial Backpack has embedded firmware with character generator.
+ * The X and Y reference coordinates are used by the text generator to place text at specific locations on the screen.
+ * The coordinates refer to the upper left most pixel in the character space. 
+ *
+ * If the offsets are within 6 pixels of the right edge of the screen or 8 pixels of the bottom, 
+ * the text generator will revert to the next logical line for text so as to print a whole character and not parts.
+ *
+ * @param pixelX	range 0, INITIAL_pixel_MAXX (127 for LCD12864)
+ * @param pixelY	range 0, INITIAL_pixel_MAXY (63 for LCD12864)
+ *
+ */
+void serialGLCD_gotoPixel_XY(unsigned char pixelX, unsigned char pixelY)
+{
+	GLCD_Command command = { GLCD_OP_GOTO };
+	
+	// check the range
+	if (pixelX > INITIAL_pixel_MAXX) pixelX = 0;
+	if (pixelY > INITIAL_pixel_MAXY) pixelY = 0;
+	command.arg[0] = pixelX;
+	command.arg[1] = pixelY;
+	// send X, send Y
+	serialGLCD_emit(&command);
+}
+
+/** ##Serial ASCII commands - Set refX and refY Coordinates referred to the character format (21x8 for 128x64).
+ * 
+ * Coordinate transformation follows the display geometry descriptor (serialGLCD.h) and 6x8 character format.
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * Consider UART was initialized and enabled.
+ * - Details:
+ *		- 21x8 format emulates  character display with 21 symbols on 8 rows (26x16 for LCD160128)
+ *		- Coordinates are indexed from 0, 0
+ *		- Coordinates are referred to 6x8 pixels sized characters
+ * @param refX		range 0, GLCD_COLS - 1
+ * @param refY		range 0, GLCD_ROWS - 1
+ * 
+ */
+void serialGLCD_goto21x8_XY(unsigned char refX, unsigned char refY)
+{
+	// check the range
+	if (refX >= GLCD_COLS) refX = 0;
+	if (refY >= GLCD_ROWS) refY = 0;
+	
+	// goto pixel X, Y
+	serialGLCD_gotoPixel_XY(GLCD_CELL_X(refX), GLCD_CELL_Y(refY));
+}
+
+/** ##Serial GLCD - Send A String of Characters.
+ * 
+ * This command send a string of characters to GLCD
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * - Consider UART was initialized and enabled.
+ * - Consider needed X, Y coordinates have been set before.
+ * - First character of the string is being displayed at current X, Y position.
+ *
+ * @param refX, refY Coordinates indexed from 0 !!
+ * @param *myString Points to the elements of the string to be sent to LCD
+ *
+ */
+void serialGLCD_sendString_at_21x8(unsigned char refX, unsigned char refY, char *myString)
+{
+	serialGLCD_goto21x8_XY(refX, refY);
+	while (*myString > 0)
+	{
+		serialGLCD_sendChar(*myString++);
+	}
+	
+}
+
+/** ##Serial ASCII commands - drawBox.
+ * 
+ * Set X and Y referred to the Pixel level coordinates
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * Consider UART was initialized and enabled.
+ *
+ * Sending hex value 0x0F followed by two sets of (x, y) coordinates defining opposite corners of the box, 
+ * followed by a 0 or 1 determines whether to draw or erase the box. This command is exactly like the draw line command, 
+ * but instead of drawing a line you get a box that exactly contains the line between the given coordinates.
+ *
+ * Coordinates are indexed from 0, 0 referred to the upper left corner of the display.
+ * @param TopLeftX, TopLeftY Coordinates of the upper left corner of the box.
+ * @param BottomRightX, BottomRightY Coordinates of the upper left corner of the box.
+ * @param draw Defines whether we draw the box or erase the box
+ *
+ */
+void serialGLCD_drawBox(unsigned char TopLeftX, unsigned char TopLeftY, unsigned char BottomRightX, unsigned char BottomRightY, unsigned char draw)
+{
+	// command identificator 0x7C (tells Sparkfun's backpack MCU the next data on RxD will be command), then 0x0F
+	GLCD_Command command = { GLCD_OP_BOX, { TopLeftX, TopLeftY, BottomRightX, BottomRightY, draw } };
+	
+	serialGLCD_emit(&command);
+}
+
+
+/** ##Serial ASCII commands - drawLine.
+ * 
+ * Draw or erase a line between two pixel level coordinates
+ *
+ * [SparkFun items](https://learn.sparkfun.com/tutorials/serial-graphic-lcd-hookup/?_ga=1.12355956.1126191215.1366741676)
+ *
+ * Consider UART was initialized and enabled.
+ *
+ * Sending hex value 0x0C followed by two sets of (x, y) coordinates defining the ends of the line,
+ * followed by a 0 or 1 determines whether to draw or erase the line.
+ * A line with both ends at the same coordinates sets or resets a single pixel.
+ *
+ * Whole command is 7 bytes, ~0.6ms on the wire at 115200 baud.
+ *
+ * @param StartX, StartY Coordinates of the first end of the line.
+ * @param EndX, EndY Coordinates of the second end of the line.
+ * @param draw Defines whether we draw the line or erase the line
+ *
+ */
+void serialGLCD_drawLine(unsigned char StartX, unsigned char StartY, unsigned char EndX, unsigned char EndY, unsigned char draw)
+{
+	// command identificator 0x7C, then 0x0C
+	GLCD_Command command = { GLCD_OP_LINE, { StartX, StartY, EndX, EndY, draw } };
+	
+	serialGLCD_emit(&command);
+}
\ No newline at end of file
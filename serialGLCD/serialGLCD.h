@@ -1,21 +1,116 @@
-#ifndef serialCLCD
-#define serialGLCD
-
-#define LCD12864
-
-#ifdef LCD12864
-	#define INITIAL_pixel_MAXX	127
-	#define INITIAL_pixel_MAXY	63
-#endif
-
-
-void serialGLCD_backlight(unsigned char backlight);
-void serialGLCD_gotoPixel_XY(unsigned char pixelX, unsigned char pixelY);	// X = 0, 127; Y = 0, 63
-void serialGLCD_goto21x8_XY(unsigned char refX, unsigned char refY);		// X = 0, 20; Y = 0, 7
-void serialGLCD_reverse();
-void serialGLCD_clear();
-void serialGLCD_sendChar(unsigned char myChar);
-void serialGLCD_sendString(char *myString);
-void serialGLCD_drawBox(unsigned char TopLeftX, unsigned char TopLeftY, unsigned char BottomRightX, unsigned char BottomRightY, unsigned char draw);
-
+#ifndef serialGLCD
+#define serialGLCD
+
+#include "main.h"
+
+/** \brief Display geometry, compile time descriptor.
+ * 
+ * Select the panel of the SparkFun Graphic LCD Serial Backpack, all coordinate math, range checks and 
+ * character viewport sizes (menu rows, text regions) are derived from it. Could be given on the command line as well (-DLCD160128).
+ * The backpack's character generator uses 6x8 pixels cells, thus:
+ * - LCD12864		128x64 pixels, 21x8 characters
+ * - LCD160128		160x128 pixels, 26x16 characters
+ */
+#if !defined(LCD12864) && !defined(LCD160128)
+	#define LCD12864
+#endif
+
+#ifdef LCD12864
+	#define GLCD_PIXELS_X		128
+	#define GLCD_PIXELS_Y		64
+	#define GLCD_QUEUE_SIZE		32		///< transmit queue size per display, must be a power of 2. A full menu row (goto + 21 characters) fits in.
+#endif
+
+#ifdef LCD160128
+	#define GLCD_PIXELS_X		160
+	#define GLCD_PIXELS_Y		128
+	#define GLCD_QUEUE_SIZE		64		///< transmit queue size per display, must be a power of 2. A full menu row (goto + 26 characters) fits in.
+#endif
+
+/*@{*/
+#define GLCD_CHAR_WIDTH			6								///< character cell width in pixels
+#define GLCD_CHAR_HEIGHT		8								///< character cell height in pixels
+#define GLCD_COLS				(GLCD_PIXELS_X / GLCD_CHAR_WIDTH)	///< characters per row
+#define GLCD_ROWS				(GLCD_PIXELS_Y / GLCD_CHAR_HEIGHT)	///< character rows
+#define INITIAL_pixel_MAXX		(GLCD_PIXELS_X - 1)
+#define INITIAL_pixel_MAXY		(GLCD_PIXELS_Y - 1)
+#define GLCD_CELL_X(refX)		((unsigned char)((refX) * GLCD_CHAR_WIDTH))		///< pixel X of a character column, folded into a constant for constant arguments
+#define GLCD_CELL_Y(refY)		((unsigned char)((refY) * GLCD_CHAR_HEIGHT))	///< pixel Y of a character row, folded into a constant for constant arguments
+/*@}*/
+
+#define GLCD_PEEPHOLE_WINDOW	4		///< commands held back per display for the peephole stage (GLCD_PEEPHOLE)
+#define GLCD_UNKNOWN			0xFF	///< shadow state not known (e.g. cursor after reset), never equal to a valid value
+
+/*@{*/
+#define GLCD_OP_CHAR			0		///< character, arg: character
+#define GLCD_OP_GOTO			1		///< set X and Y, arg: pixel X, pixel Y
+#define GLCD_OP_CLEAR			2		///< clear screen
+#define GLCD_OP_BACKLIGHT		3		///< backlight duty cycle, arg: duty cycle
+#define GLCD_OP_REVERSE			4		///< toggle reverse mode, clears the screen
+#define GLCD_OP_BOX				5		///< box, arg: X1, Y1, X2, Y2, draw
+#define GLCD_OP_LINE			6		///< line, arg: X1, Y1, X2, Y2, draw
+/*@}*/
+
+/**
+ * A structure to represent one backpack command before it is encoded to bytes
+ */
+typedef struct GLCDCommandStructure {
+	unsigned char op;								/**< GLCD_OP_CHAR, GLCD_OP_GOTO, ... */
+	unsigned char arg[5];							/**< arguments, see the GLCD_OP_* */
+}GLCD_Command;
+
+/**
+ * A structure to represent one serial GLCD panel (display handle)
+ */
+typedef struct GLCDStructure {
+	/*@{*/
+	unsigned char ( *ready ) (void);				/**< transport function, returns non zero if next byte can be transmitted */
+	void ( *transmit ) (unsigned char data);		/**< transport function, puts one byte on the wire */
+	/*@}*/
+	/*@{*/
+	unsigned char queue[GLCD_QUEUE_SIZE];			/**< transmit queue */
+	unsigned char pace[GLCD_QUEUE_SIZE];			/**< delay in ms the backpack needs after respective queued byte */
+	unsigned char head;								/**< next free place in the queue */
+	unsigned char tail;								/**< next byte to be transmitted */
+	unsigned long holdUntil;						/**< time stamp (timer ticks) when the pacing of the last transmitted byte is over */
+	/*@}*/
+	/*@{*/
+	unsigned char pixelX;							/**< shadow state - text cursor pixel X */
+	unsigned char pixelY;							/**< shadow state - text cursor pixel Y */
+	unsigned char backlight;						/**< shadow state - last sent backlight duty cycle */
+	unsigned char reverse;							/**< shadow state - reverse display mode */
+	unsigned char blank;							/**< shadow state - nothing drawn since the last clear */
+	/*@}*/
+#if (GLCD_PEEPHOLE == TRUE)
+	/*@{*/
+	GLCD_Command window[GLCD_PEEPHOLE_WINDOW];		/**< commands held back, the oldest first */
+	unsigned char pending;							/**< number of commands held back */
+	/*@}*/
+#endif
+	struct GLCDStructure *next;						/**< next registered display */
+}GLCD_Display;
+
+extern GLCD_Display serialGLCD_main;
+extern GLCD_Display *serialGLCD_displays;
+extern GLCD_Display *serialGLCD_active;
+extern volatile unsigned char serialGLCD_probe;
+extern unsigned long serialGLCD_probeTick;
+
+void serialGLCD_register(GLCD_Display *display, unsigned char (*ready)(void), void (*transmit)(unsigned char data));
+void serialGLCD_select(GLCD_Display *display);
+unsigned char serialGLCD_service(void);
+void serialGLCD_flush(void);
+unsigned char serialGLCD_busy(void);
+void serialGLCD_put(unsigned char data, unsigned char pace);
+
+void serialGLCD_backlight(unsigned char backlight);
+void serialGLCD_gotoPixel_XY(unsigned char pixelX, unsigned char pixelY);	// X = 0, INITIAL_pixel_MAXX; Y = 0, INITIAL_pixel_MAXY
+void serialGLCD_goto21x8_XY(unsigned char refX, unsigned char refY);		// X = 0, GLCD_COLS - 1; Y = 0, GLCD_ROWS - 1
+void serialGLCD_reverse();
+void serialGLCD_clear();
+void serialGLCD_sendChar(unsigned char myChar);
+void serialGLCD_sendString(char *myString);
+void serialGLCD_drawBox(unsigned char TopLeftX, unsigned char TopLeftY, unsigned char BottomRightX, unsigned char BottomRightY, unsigned char draw);
+void serialGLCD_drawLine(unsigned char StartX, unsigned char StartY, unsigned char EndX, unsigned char EndY, unsigned char draw);
+
 #endif // serialGLCD
\ No newline at end of file
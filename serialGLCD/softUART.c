@@ -0,0 +1,63 @@
+﻿/** \page pageSoftUART Software UART
+ * 
+ * ##Bit-banged UART transmitter
+ *
+ * softUART.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Transmit only, 8 data bits, 1 stop bit, no parity, as needed by the serial GLCD backpack
+ * - Used as a transport of a second GLCD_Display (see serialGLCD_register())
+ * - A byte takes ~87us at 115200 baud. Interrupts are disabled while a byte is being sent to keep the bit timing,
+ *   meanwhile hardware UART0 transmits its own byte, thus both panels are fed in parallel
+ *
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "main.h"
+#include "ports_and_pins.h"
+#include "softUART.h"
+#include <util/delay.h>
+
+/** ##Software UART - initialization
+ * TX pin as output, idle HIGH (mark).
+ */
+void softUART_init(void)
+{
+	PIN_HIGH(PIN_SOFTUART_TX);
+	PIN_OUTPUT(PIN_SOFTUART_TX);
+}
+
+/** ##Software UART - ready to accept next byte
+ * Transmission is blocking, thus the transmitter is always ready.
+ */
+unsigned char softUART_ready(void)
+{
+	return 1;
+}
+
+/** ##Software UART - send a byte
+ * 
+ * Start bit (LOW), 8 data bits LSB first, stop bit (HIGH).
+ * @param data Byte to be sent
+ *
+ */
+void softUART_transmit(unsigned char data)
+{
+	unsigned char sreg = SREG;
+	unsigned char bit_cnt;
+	
+	cli();
+	PIN_LOW(PIN_SOFTUART_TX);		// start bit
+	_delay_us(SOFTUART_BIT_DELAY);
+	for (bit_cnt = 8; bit_cnt; bit_cnt--)
+	{
+		if (data & 0x01) PIN_HIGH(PIN_SOFTUART_TX); else PIN_LOW(PIN_SOFTUART_TX);
+		data >>= 1;
+		_delay_us(SOFTUART_BIT_DELAY);
+	}
+	PIN_HIGH(PIN_SOFTUART_TX);		// stop bit
+	_delay_us(SOFTUART_BIT_DELAY);
+	SREG = sreg;
+}
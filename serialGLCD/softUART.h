@@ -0,0 +1,14 @@
+﻿/*
+ * softUART.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef SOFTUART_H_
+#define SOFTUART_H_
+
+void softUART_init(void);
+unsigned char softUART_ready(void);
+void softUART_transmit(unsigned char data);
+
+#endif /* SOFTUART_H_ */
@@ -0,0 +1,70 @@
+﻿/** \page pageTimer MCU's Timer1 time base
+ * 
+ * ##Free running time base for timestamps and non-blocking timeouts
+ *
+ * timer.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Timer1 in normal mode, prescaler 64, thus 4us per tick at F_CPU 16MHz
+ * - Overflow interrupt extends the 16-bit counter to 32 bits, it wraps after ~4.7 hours
+ * - Compare the time stamps by difference (e.g. (long)(now - then) >= 0), thus the wrap around is handled
+ *
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "main.h"
+#include "timer.h"
+
+static volatile unsigned int timer_overflows = 0;		///< upper 16 bits of the time base
+
+/** ##Timer1 overflow interrupt
+ */
+ISR(TIMER1_OVF_vect)
+{
+	timer_overflows++;
+}
+
+/** ##Time base initialization
+ * 
+ * Timer1 normal mode, prescaler 64, overflow interrupt enabled.
+ * Consider global interrupts are to be enabled (sei) afterwards.
+ *
+ */
+void timer_init(void)
+{
+	TCCR1A = 0;
+	TCCR1B = (1 << CS11) | (1 << CS10);		// clk/64
+	TCNT1 = 0;
+	TIFR1 = (1 << TOV1);						// clear pending overflow
+	TIMSK1 |= (1 << TOIE1);
+}
+
+/** ##Time base - ticks since timer_init()
+ *
+ * Safe to call from ISRs and main context.
+ * If the counter has just overflowed and the interrupt is not served yet (interrupts disabled), the overflow is added here.
+ * @return time in TIMER_TICK_US units
+ *
+ */
+unsigned long timer_ticks(void)
+{
+	unsigned char sreg = SREG;
+	unsigned int low;
+	unsigned int high;
+	
+	cli();
+	low = HAL_TIMER1_COUNT();
+	high = timer_overflows;
+	if (HAL_TIMER1_OVERFLOW() && (low < 0x8000)) high++;
+	SREG = sreg;
+	return ((unsigned long)high << 16) | low;
+}
+
+/** ##Time base - milliseconds since timer_init()
+ */
+unsigned long timer_millis(void)
+{
+	return timer_ticks() / TIMER_TICKS_PER_MS;
+}
@@ -0,0 +1,19 @@
+﻿/*
+ * timer.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef TIMER_H_
+#define TIMER_H_
+
+/*@{*/
+#define TIMER_TICK_US		4					///< Timer1 tick in us, F_CPU / 64 prescaler
+#define TIMER_TICKS_PER_MS	(1000 / TIMER_TICK_US)	///< Timer1 ticks in 1ms
+/*@}*/
+
+void timer_init(void);
+unsigned long timer_ticks(void);
+unsigned long timer_millis(void);
+
+#endif /* TIMER_H_ */
@@ -0,0 +1,153 @@
+﻿/** \page pageTimerWheel Software timers
+ *
+ * ##Timer wheel for timeouts, periodic refresh and blink effects, callbacks in main context
+ *
+ * timerWheel.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Time base is the Timer1 time stamp (see timer.c), advanced in TIMER_WHEEL_TICK_MS steps
+ * - Armed timers are kept in TIMER_WHEEL_SLOTS lists indexed by the expiry tick, thus arm and cancel are O(1)
+ * - timerWheel_service() is called from the main loop (and from the loop of a menu handler using timers while it waits for events),
+ *   it visits the slots of the ticks passed and calls the callbacks of the expired timers. Nothing runs in the interrupt.
+ * - A timer further than one turn of the wheel stays in its slot, it is skipped until its tick comes
+ * - Periodic timer is re-armed before its callback, thus the callback could cancel it
+ * - The main loop did not serve the wheel for long (a blocking redraw): the expired timers are called once,
+ *   a periodic one continues a period later, the missed periods are not repeated
+ *
+ * Example, blink every 500ms:
+ *
+ *		static TimerWheelTimer blinkTimer;
+ *		timerWheel_arm(&blinkTimer, 500, 500, blink, 0);
+ *
+ */
+
+#include "main.h"
+#include "timer.h"
+#include "timerWheel.h"
+
+#define TIMER_WHEEL_TICKS		((unsigned long)TIMER_WHEEL_TICK_MS * TIMER_TICKS_PER_MS)	///< Timer1 ticks of one wheel tick
+
+static TimerWheelTimer *timerWheel_slots[TIMER_WHEEL_SLOTS];	///< armed timers by expiry tick
+static unsigned long timerWheel_now = 0;						///< wheel time, in wheel ticks
+static unsigned long timerWheel_stamp = 0;						///< Timer1 time stamp of 'timerWheel_now'
+static unsigned long timerWheel_tick = 0;						///< last wheel tick served, 'timerWheel_now' out of timerWheel_service()
+static unsigned char timerWheel_count = 0;						///< number of armed timers
+
+/** ##Timer wheel - wheel ticks passed since 'timerWheel_now'
+ */
+static unsigned long timerWheel_elapsed(void)
+{
+	return (timer_ticks() - timerWheel_stamp) / TIMER_WHEEL_TICKS;
+}
+
+/** ##Timer wheel - put an armed timer to the slot of its expiry tick
+ */
+static void timerWheel_link(TimerWheelTimer *timer)
+{
+	TimerWheelTimer **slot = &timerWheel_slots[timer->due & (TIMER_WHEEL_SLOTS - 1)];
+
+	timer->prev = 0;
+	timer->next = *slot;
+	if (*slot) (*slot)->prev = timer;
+	*slot = timer;
+	timer->armed = 1;
+	timerWheel_count++;
+}
+
+/** ##Timer wheel - take a timer out of its slot
+ */
+static void timerWheel_unlink(TimerWheelTimer *timer)
+{
+	if (timer->prev) timer->prev->next = timer->next;
+	else timerWheel_slots[timer->due & (TIMER_WHEEL_SLOTS - 1)] = timer->next;
+	if (timer->next) timer->next->prev = timer->prev;
+	timer->armed = 0;
+	timerWheel_count--;
+}
+
+/** ##Timer wheel - arm a timer
+ *
+ * An armed timer is re-armed. Not to be called from interrupts.
+ * @param timer Timer to be armed, kept by the caller while armed
+ * @param delay_ms Time to the first expiry in ms, rounded up to TIMER_WHEEL_TICK_MS (at least one tick)
+ * @param period_ms Period in ms of the following expiries, 0 for a one-shot timer
+ * @param callback Function called on expiry from timerWheel_service()
+ * @param context Passed to the callback
+ *
+ */
+void timerWheel_arm(TimerWheelTimer *timer, unsigned int delay_ms, unsigned int period_ms, void (*callback)(void *context), void *context)
+{
+	unsigned int delay = (delay_ms + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS;
+
+	if (timer->armed) timerWheel_unlink(timer);
+	if (delay == 0) delay = 1;
+	timer->due = timerWheel_now + timerWheel_elapsed() + delay;
+	timer->period = (period_ms + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS;
+	if (period_ms && (timer->period == 0)) timer->period = 1;
+	timer->callback = callback;
+	timer->context = context;
+	timerWheel_link(timer);
+}
+
+/** ##Timer wheel - cancel a timer
+ *
+ * Nothing is done if the timer is not armed (expired one-shot, cancelled before).
+ * @param timer Timer to be cancelled
+ *
+ */
+void timerWheel_cancel(TimerWheelTimer *timer)
+{
+	if (timer->armed) timerWheel_unlink(timer);
+}
+
+/** ##Timer wheel - call the callbacks of the expired timers
+ *
+ * To be called from the main loop while waiting for events, the callbacks run here.
+ * Keeps the wheel time up to date even when no timer is armed, thus it is to be called regularly (Timer1 time stamp wraps after ~4.7 hours).
+ * A slot is scanned again from its beginning after each callback, the callback could arm or cancel any timer.
+ *
+ */
+void timerWheel_service(void)
+{
+	unsigned long elapsed;
+	unsigned long now;
+	TimerWheelTimer *timer;
+
+	elapsed = timerWheel_elapsed();
+	if (elapsed == 0) return;
+	timerWheel_stamp += elapsed * TIMER_WHEEL_TICKS;
+	now = timerWheel_now + elapsed;
+	timerWheel_now = now;			// timers armed by the callbacks count from now
+	if (timerWheel_count == 0)
+	{
+		// nothing armed, the time base is kept up to date only
+		timerWheel_tick = now;
+		return;
+	}
+
+	// one turn covers every slot, the ticks before it are not visited one by one
+	if (elapsed > TIMER_WHEEL_SLOTS) timerWheel_tick = now - TIMER_WHEEL_SLOTS;
+	while (timerWheel_tick != now)
+	{
+		timerWheel_tick++;
+		timer = timerWheel_slots[timerWheel_tick & (TIMER_WHEEL_SLOTS - 1)];
+		while (timer)
+		{
+			if ((long)(timer->due - timerWheel_tick) > 0)
+			{
+				timer = timer->next;
+				continue;
+			}
+			timerWheel_unlink(timer);
+			if (timer->period)
+			{
+				timer->due += timer->period;
+				if ((long)(timer->due - now) <= 0) timer->due = now + timer->period;
+				timerWheel_link(timer);
+			}
+			timer->callback(timer->context);
+			timer = timerWheel_slots[timerWheel_tick & (TIMER_WHEEL_SLOTS - 1)];
+		}
+	}
+}
@@ -0,0 +1,36 @@
+﻿/*
+ * timerWheel.h
+ *
+ * \author Simeon Neykov
+ */
+
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+/*@{*/
+#define TIMER_WHEEL_TICK_MS		10		///< Given in ms. Resolution of the software timers
+#define TIMER_WHEEL_SLOTS		16		///< slots of the wheel, power of 2. Timers further than one turn wait in their slot for more turns
+/*@}*/
+
+/**
+ * A structure to represent a software timer, owned by the caller (static or a member of the widget using it)
+ */
+typedef struct TimerWheelStructure {
+	/*@{*/
+	struct TimerWheelStructure *next;			/**< slot list */
+	struct TimerWheelStructure *prev;			/**< slot list, 0 for the first timer of the slot */
+	unsigned long due;							/**< wheel tick of the expiry */
+	unsigned int period;						/**< wheel ticks of a periodic timer, 0 one-shot */
+	unsigned char armed;						/**< timer is in the wheel */
+	/*@}*/
+	/*@{*/
+	void ( *callback ) (void *context);			/**< called from timerWheel_service() on expiry, main context */
+	void *context;								/**< passed to the callback */
+	/*@}*/
+}TimerWheelTimer;
+
+void timerWheel_arm(TimerWheelTimer *timer, unsigned int delay_ms, unsigned int period_ms, void (*callback)(void *context), void *context);
+void timerWheel_cancel(TimerWheelTimer *timer);
+void timerWheel_service(void);
+
+#endif /* TIMERWHEEL_H_ */
@@ -0,0 +1,143 @@
+﻿/** \page pageTrace Binary Event Trace
+ * 
+ * ##Time stamped binary event trace for input to screen latency measurements
+ *
+ * trace.c
+ *
+ * \author	Simeon Neykov.
+ *
+ * - Fixed size ring of 4-byte records: event id, argument, 16-bit time stamp (64us units)
+ * - trace_event() is safe from ISRs and main context (interrupts disabled while a record is written)
+ * - Input edges are traced by the pin change interrupt of port C, thus the time stamp is the edge itself and not the polling moment
+ * - Records are drained over the software UART (debug port, see softUART.c) only while the main panel's queue is empty,
+ *   thus draining doesn't delay any frame
+ * - Record on the wire: TRACE_SYNC, id, arg, time stamp low byte, time stamp high byte
+ * - Use tools/traceDecode.c on a Linux host to turn the captured stream into latency histograms and per-stage breakdown
+ * - Enabled by TRACE_ENABLE in main.h. Software UART is shared with GLCD_SECOND_PANEL, only one of them could be enabled
+ *
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "main.h"
+#include "serialGLCD.h"
+#include "softUART.h"
+#include "timer.h"
+#include "ports_and_pins.h"
+#include "trace.h"
+
+#if (TRACE_ENABLE == TRUE) && (GLCD_SECOND_PANEL == TRUE)
+	#error "TRACE_ENABLE and GLCD_SECOND_PANEL both use the software UART"
+#endif
+
+/**
+ * A structure to represent one trace record
+ */
+typedef struct TraceStructure {
+	unsigned char id;				/**< event identifier */
+	unsigned char arg;				/**< event argument */
+	unsigned int tick;				/**< time stamp, Timer1 ticks >> TRACE_TICK_SHIFT */
+}TraceRecord;
+
+static TraceRecord trace_ring[TRACE_SIZE];
+static volatile unsigned char trace_head = 0;
+static volatile unsigned char trace_tail = 0;
+static volatile unsigned char trace_lost = 0;
+static GLCD_Display trace_port;		///< debug port, transport is the software UART
+
+#if (TRACE_ENABLE == TRUE)
+/** ##Pin change interrupt of port C - trace input edges
+ */
+ISR(PCINT1_vect)
+{
+	trace_event(TRACE_INPUT_EDGE, HAL_PINC());
+}
+#endif
+
+/** ##Trace - initialization
+ *
+ * - debug port on the software UART is registered as a display handle (it is never selected by the application)
+ * - pin change interrupt is enabled for the buttons and the rotary encoder pins (port C)
+ * - Consider timer_init() was called and global interrupts are enabled afterwards
+ *
+ */
+void trace_init(void)
+{
+	softUART_init();
+	serialGLCD_register(&trace_port, softUART_ready, softUART_transmit);
+	
+	PCMSK1 |= PIN_MASK(PIN_BUTTON_ENTER) | PIN_MASK(PIN_BUTTON_UP) | PIN_MASK(PIN_BUTTON_DOWN) | PIN_MASK(PIN_ROTARY_DATA) | PIN_MASK(PIN_ROTARY_CLK);
+	PCICR |= (1 << PCIE1);
+}
+
+/** ##Trace - record an event
+ *
+ * If the ring is full the event is dropped and counted, the count is reported with TRACE_LOST.
+ * @param id Event identifier, see TRACE_INPUT_EDGE etc
+ * @param arg Event argument
+ *
+ */
+void trace_event(unsigned char id, unsigned char arg)
+{
+	unsigned char sreg = SREG;
+	unsigned char head;
+	unsigned int tick;
+	
+	cli();
+	tick = (unsigned int)(timer_ticks() >> TRACE_TICK_SHIFT);
+	head = (trace_head + 1) & (TRACE_SIZE - 1);
+	if (head == trace_tail)
+	{
+		if (trace_lost < 255) trace_lost++;
+	} else {
+		trace_ring[trace_head].id = id;
+		trace_ring[trace_head].arg = arg;
+		trace_ring[trace_head].tick = tick;
+		trace_head = head;
+	}
+	SREG = sreg;
+}
+
+/** ##Trace - drain one record over the debug port
+ *
+ * To be called from the main loop. A record is queued only if:
+ * - the main panel has nothing to send (the link is idle)
+ * - the debug port queue has room for a whole record
+ *
+ */
+void trace_drain(void)
+{
+	GLCD_Display *active = serialGLCD_active;
+	TraceRecord record;
+	unsigned char sreg;
+	unsigned char used;
+	
+	if (serialGLCD_main.head != serialGLCD_main.tail) return;
+	used = (trace_port.head - trace_port.tail) & (GLCD_QUEUE_SIZE - 1);
+	if (GLCD_QUEUE_SIZE - 1 - used < 5) return;		// record is 5 bytes on the wire
+	
+	sreg = SREG;
+	cli();
+	if (trace_lost)
+	{
+		record.id = TRACE_LOST;
+		record.arg = trace_lost;
+		record.tick = (unsigned int)(timer_ticks() >> TRACE_TICK_SHIFT);
+		trace_lost = 0;
+	} else if (trace_head != trace_tail) {
+		record = trace_ring[trace_tail];
+		trace_tail = (trace_tail + 1) & (TRACE_SIZE - 1);
+	} else {
+		SREG = sreg;
+		return;
+	}
+	SREG = sreg;
+	
+	serialGLCD_select(&trace_port);
+	serialGLCD_put(TRACE_SYNC, 0);
+	serialGLCD_put(record.id, 0);
+	serialGLCD_put(record.arg, 0);
+	serialGLCD_put((unsigned char)record.tick, 0);
+	serialGLCD_put((unsigned char)(record.tick >> 8), 0);
+	serialGLCD_select(active);
+}
@@ -0,0 +1,40 @@
+﻿/*
+ * trace.h
+ *
+ * \author Simeon Neykov
+ */ 
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "main.h"
+
+/*@{*/
+#define TRACE_SIZE			32					///< number of records in the trace ring, must be a power of 2. Each record takes 4 bytes of SRAM
+#define TRACE_TICK_SHIFT	4					///< trace time stamp is Timer1 ticks >> TRACE_TICK_SHIFT, thus 64us resolution and 4.2s wrap around
+#define TRACE_SYNC			0xA5				///< first byte of each record on the wire
+/*@}*/
+
+/** 
+ * Trace event identifiers. Keep in sync with tools/traceDecode.c
+ */
+enum {
+	TRACE_INPUT_EDGE = 1,						///< pin change on port C, arg = PINC
+	TRACE_MENU_START = 2,						///< show_menu() entered, arg = selected
+	TRACE_ROW_EMIT = 3,							///< a menu row is queued for the display, arg = row
+	TRACE_MENU_END = 4,							///< show_menu() finished queuing, arg = selected
+	TRACE_UART_IDLE = 5,						///< last queued byte of the main panel loaded into UDR0, arg = 0
+	TRACE_LOST = 6,								///< records lost due to full ring, arg = number of lost records (saturated at 255)
+};
+
+#if (TRACE_ENABLE == TRUE)
+	#define TRACE(id, arg)		trace_event((id), (arg))	///< trace an event, compiled out if TRACE_ENABLE is FALSE
+#else
+	#define TRACE(id, arg)
+#endif
+
+void trace_init(void);
+void trace_event(unsigned char id, unsigned char arg);
+void trace_drain(void);
+
+#endif /* TRACE_H_ */
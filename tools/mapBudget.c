@@ -0,0 +1,239 @@
+/*
+ * mapBudget.c
+ *
+ * \author Simeon Neykov
+ *
+ * Linux host report of the per-module memory usage from the GNU linker map (e.g. Debug/serialGLCD.map).
+ *
+ * Build:	gcc -O2 -o mapBudget mapBudget.c
+ * Use:		./mapBudget serialGLCD.map [budget.txt]
+ *
+ * - Input sections of the memory map are summed per object file, archive members per archive (libc.a, ...)
+ *		text	.text*, .progmem*, .init*, .fini*, .vectors (flash only)
+ *		data	.data*, .rodata* (flash and SRAM, avr-gcc keeps constants in SRAM)
+ *		bss		.bss*, COMMON, .noinit* (SRAM only)
+ * - Budget file lines, '-' means no limit, '#' starts a comment:
+ *		<module> <text> <data> <bss>	limits of one module (name as printed in the report)
+ *		total <text> <data> <bss>		limits of the whole image
+ *		ram <bytes>						limit of data + bss, the rest of the SRAM is left to the stack
+ * - Exit status 1 if any budget is exceeded, thus a Makefile rule using it fails
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_MODULES		128
+#define NAME_SIZE		64
+#define NO_LIMIT		(-1L)
+
+enum { TEXT, DATA, BSS, KINDS };
+
+static const char *kind_names[KINDS] = { "text", "data", "bss" };
+
+typedef struct {
+	char name[NAME_SIZE];
+	long size[KINDS];
+} Module;
+
+static Module modules[MAX_MODULES];
+static int module_count;
+
+/* section name to the memory kind, -1 if not counted (debug info, fill, ...) */
+static int section_kind(const char *section)
+{
+	static const struct { const char *prefix; int kind; } map[] = {
+		{ ".text", TEXT }, { ".progmem", TEXT }, { ".init", TEXT }, { ".fini", TEXT }, { ".vectors", TEXT },
+		{ ".trampolines", TEXT }, { ".data", DATA }, { ".rodata", DATA }, { ".bss", BSS }, { "COMMON", BSS },
+		{ ".noinit", BSS },
+	};
+	for (size_t i = 0; i < sizeof(map) / sizeof(map[0]); i++)
+	{
+		if (!strncmp(section, map[i].prefix, strlen(map[i].prefix))) return map[i].kind;
+	}
+	return -1;
+}
+
+/* module name of an input file: object file name, or archive name for archive members, without directories */
+static void module_name(const char *file, char *name)
+{
+	char buffer[512];
+	char *base;
+	char *member;
+
+	snprintf(buffer, sizeof(buffer), "%s", file);
+	member = strrchr(buffer, '(');
+	if (member && (buffer[strlen(buffer) - 1] == ')')) *member = 0;
+	base = buffer + strlen(buffer);
+	while ((base > buffer) && (base[-1] != '/') && (base[-1] != '\\')) base--;
+	snprintf(name, NAME_SIZE, "%.*s", NAME_SIZE - 1, base);
+}
+
+static Module *module_find(const char *name, int create)
+{
+	for (int i = 0; i < module_count; i++)
+	{
+		if (!strcmp(modules[i].name, name)) return &modules[i];
+	}
+	if (!create) return NULL;
+	if (module_count == MAX_MODULES)
+	{
+		fprintf(stderr, "too many modules\n");
+		exit(2);
+	}
+	snprintf(modules[module_count].name, NAME_SIZE, "%s", name);
+	return &modules[module_count++];
+}
+
+static void trim(char *text)
+{
+	size_t len = strlen(text);
+	while (len && isspace((unsigned char)text[len - 1])) text[--len] = 0;
+}
+
+/* input section line: " .section 0xaddress 0xsize file", the name may be alone on the line and the rest on the next one */
+static int map_read(const char *path)
+{
+	char line[1024];
+	char section[256] = "";
+	int in_map = 0;
+	FILE *map = fopen(path, "r");
+
+	if (!map)
+	{
+		perror(path);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), map))
+	{
+		char *rest = line;
+		unsigned long address;
+		unsigned long size;
+		int used;
+
+		trim(line);
+		if (!in_map)
+		{
+			in_map = !strncmp(line, "Linker script and memory map", 28);
+			continue;
+		}
+		if ((line[0] == ' ') && (line[1] != ' '))
+		{
+			// new input section
+			rest = line + 1;
+			used = 0;
+			sscanf(rest, "%255s%n", section, &used);
+			rest += used;
+		}
+		else if (strncmp(line, "                ", 16) || !section[0])
+		{
+			section[0] = 0;
+			continue;
+		}
+		if (sscanf(rest, " 0x%lx 0x%lx %n", &address, &size, &used) < 2)
+		{
+			continue;		// name only, the numbers follow on the next line; or a symbol line
+		}
+		rest += used;
+		if (*rest && size && (section_kind(section) >= 0))
+		{
+			char name[NAME_SIZE];
+			module_name(rest, name);
+			module_find(name, 1)->size[section_kind(section)] += size;
+		}
+		section[0] = 0;
+	}
+	fclose(map);
+	if (!in_map)
+	{
+		fprintf(stderr, "%s: no memory map found\n", path);
+		return -1;
+	}
+	return 0;
+}
+
+static long limit_parse(const char *text)
+{
+	return strcmp(text, "-") ? atol(text) : NO_LIMIT;
+}
+
+static int check(const char *what, const char *kind, long size, long limit)
+{
+	if ((limit == NO_LIMIT) || (size <= limit)) return 0;
+	printf("OVER BUDGET: %s %s %ld > %ld\n", what, kind, size, limit);
+	return 1;
+}
+
+static int budget_check(const char *path, const Module *total)
+{
+	char line[256];
+	int over = 0;
+	int line_number = 0;
+	FILE *budget = fopen(path, "r");
+
+	if (!budget)
+	{
+		perror(path);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), budget))
+	{
+		char name[NAME_SIZE];
+		char limit[KINDS][32];
+		char *comment = strchr(line, '#');
+		int fields;
+
+		line_number++;
+		if (comment) *comment = 0;
+		fields = sscanf(line, "%63s %31s %31s %31s", name, limit[TEXT], limit[DATA], limit[BSS]);
+		if (fields <= 0) continue;
+		if (!strcmp(name, "ram") && (fields == 2))
+		{
+			over |= check("ram", "data+bss", total->size[DATA] + total->size[BSS], limit_parse(limit[TEXT]));
+		}
+		else if (fields == 4)
+		{
+			const Module *module = strcmp(name, "total") ? module_find(name, 0) : total;
+			if (!module) continue;		// module not linked, nothing to check
+			for (int k = 0; k < KINDS; k++) over |= check(name, kind_names[k], module->size[k], limit_parse(limit[k]));
+		}
+		else
+		{
+			fprintf(stderr, "%s:%d: expected \"<module> <text> <data> <bss>\" or \"ram <bytes>\"\n", path, line_number);
+			over = 1;
+		}
+	}
+	fclose(budget);
+	return over;
+}
+
+int main(int argc, char **argv)
+{
+	Module total = { "total", { 0, 0, 0 } };
+	int status = 0;
+
+	if ((argc < 2) || (argc > 3))
+	{
+		fprintf(stderr, "usage: %s file.map [budget.txt]\n", argv[0]);
+		return 2;
+	}
+	if (map_read(argv[1])) return 2;
+
+	printf("%-24s %8s %8s %8s\n", "module", "text", "data", "bss");
+	for (int i = 0; i < module_count; i++)
+	{
+		printf("%-24s %8ld %8ld %8ld\n", modules[i].name, modules[i].size[TEXT], modules[i].size[DATA], modules[i].size[BSS]);
+		for (int k = 0; k < KINDS; k++) total.size[k] += modules[i].size[k];
+	}
+	printf("%-24s %8ld %8ld %8ld\n", total.name, total.size[TEXT], total.size[DATA], total.size[BSS]);
+	printf("flash %ld bytes, static SRAM %ld bytes\n", total.size[TEXT] + total.size[DATA], total.size[DATA] + total.size[BSS]);
+
+	if (argc == 3)
+	{
+		status = budget_check(argv[2], &total);
+		if (status < 0) return 2;
+		printf(status ? "budget exceeded\n" : "within budget\n");
+	}
+	return status;
+}
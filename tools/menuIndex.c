@@ -0,0 +1,142 @@
+/*
+ * menuIndex.c
+ *
+ * \author Simeon Neykov
+ *
+ * Linux host generator of the first-letter index of the static menu (see serialGLCD/charMenu.c, menu_jump()).
+ *
+ * Build:	gcc -O2 -o menuIndex menuIndex.c
+ * Use:		./menuIndex ../serialGLCD/charMenu.c > ../serialGLCD/charMenuIndex.h
+ *
+ * - Menu texts are taken from the lines	const char menu_NNN[] = "text";
+ * - Menu items from the rows of my_menu[]	{menu_NNN, num_menupoints, up, down, enter, ...},
+ *   one row per line, in the order of the table
+ * - A section is 'num_menupoints' rows, the first one is its header and is not indexed
+ * - An item starts a group if it is the first item of its section or its first letter (case ignored)
+ *   differs from the one of the item before
+ * - Output is a header with a bit per menu item, set for the group starts. Regenerate it whenever
+ *   the menu texts or sections change, host/Makefile 'check' fails while it is out of date.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_ITEMS		255			// MENU_NO_ITEM and up are not menu items
+#define MAX_TEXTS		1000
+#define LINE_SIZE		512
+
+static char *texts[MAX_TEXTS];
+static int items[MAX_ITEMS];		// text number of each menu item
+static int points[MAX_ITEMS];		// num_menupoints of each menu item
+
+int main(int argc, char *argv[])
+{
+	FILE *in;
+	char line[LINE_SIZE];
+	char *p;
+	char *end;
+	int count = 0;
+	int inTable = 0;
+	int number;
+	int points_n;
+	int i;
+	int header;
+	unsigned char bits[(MAX_ITEMS + 7) / 8];
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "usage: %s charMenu.c > charMenuIndex.h\n", argv[0]);
+		return 2;
+	}
+	in = fopen(argv[1], "r");
+	if (!in)
+	{
+		perror(argv[1]);
+		return 2;
+	}
+	while (fgets(line, sizeof(line), in))
+	{
+		if (sscanf(line, " const char menu_%d[] = \"", &number) == 1 && (p = strchr(line, '"')) && (end = strchr(p + 1, '"')))
+		{
+			if ((number < 0) || (number >= MAX_TEXTS)) continue;
+			*end = 0;
+			free(texts[number]);
+			texts[number] = strdup(p + 1);
+			continue;
+		}
+		if (strstr(line, "my_menu[] ="))
+		{
+			inTable = 1;
+			continue;
+		}
+		if (!inTable) continue;
+		if (strstr(line, "};"))
+		{
+			inTable = 0;
+			continue;
+		}
+		if (sscanf(line, " {menu_%d, %d,", &number, &points_n) == 2)
+		{
+			if (count == MAX_ITEMS)
+			{
+				fprintf(stderr, "%s: more than %d menu items\n", argv[1], MAX_ITEMS);
+				return 1;
+			}
+			if ((number < 0) || (number >= MAX_TEXTS) || !texts[number])
+			{
+				fprintf(stderr, "%s: menu_%03d has no text\n", argv[1], number);
+				return 1;
+			}
+			items[count] = number;
+			points[count] = points_n;
+			count++;
+		}
+	}
+	fclose(in);
+	if (count == 0)
+	{
+		fprintf(stderr, "%s: my_menu[] not found\n", argv[1]);
+		return 1;
+	}
+
+	memset(bits, 0, sizeof(bits));
+	for (header = 0; header < count; header += points[header])
+	{
+		if (points[header] < 1)
+		{
+			fprintf(stderr, "%s: menu item %d has no num_menupoints\n", argv[1], header);
+			return 1;
+		}
+		for (i = header + 1; (i < header + points[header]) && (i < count); i++)
+		{
+			if ((i == header + 1) || (toupper((unsigned char)texts[items[i]][0]) != toupper((unsigned char)texts[items[i - 1]][0])))
+			{
+				bits[i / 8] |= 1 << (i % 8);
+			}
+		}
+	}
+
+	printf("/*\n");
+	printf(" * charMenuIndex.h\n");
+	printf(" *\n");
+	printf(" * Generated by tools/menuIndex from charMenu.c, do not edit.\n");
+	printf(" */\n");
+	printf("\n");
+	printf("#ifndef CHARMENUINDEX_H_\n");
+	printf("#define CHARMENUINDEX_H_\n");
+	printf("\n");
+	printf("#define MENU_INDEX_ITEMS\t%d\t\t///< number of menu items indexed\n", count);
+	printf("\n");
+	printf("/**\n");
+	printf(" * First-letter groups of the static menu, a bit per menu item (item 0 is bit 0 of the first byte).\n");
+	printf(" * Set on the first item of a group, see menu_jump().\n");
+	printf(" */\n");
+	printf("#define MENU_GROUP_STARTS\t{");
+	for (i = 0; i < (count + 7) / 8; i++) printf("%s0x%02X", i ? ", " : " ", bits[i]);
+	printf(" }\n");
+	printf("\n");
+	printf("#endif /* CHARMENUINDEX_H_ */\n");
+	return 0;
+}
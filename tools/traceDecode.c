@@ -0,0 +1,264 @@
+/*
+ * traceDecode.c
+ *
+ * \author Simeon Neykov
+ *
+ * Linux host decoder of the binary event trace (see serialGLCD/trace.c).
+ *
+ * Build:	gcc -O2 -o traceDecode traceDecode.c
+ * Capture:	stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > capture.bin
+ * Use:		./traceDecode [-e] [-b bucket_ms] [-i] capture.bin
+ *
+ * - Record on the wire: 0xA5, id, arg, time stamp low byte, time stamp high byte (64us units, wraps after 4.2s)
+ * - Interaction: first input edge -> show_menu start -> first row -> show_menu end -> main panel UART idle
+ * - Output: per-stage latency statistics and histogram of input to last byte latency
+ *		-e		dump decoded events
+ *		-b ms	histogram bucket width, default 20ms
+ *		-i		print the input edges as a replay script for host/ instead (port C levels, first edge at 5s after boot)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_SYNC		0xA5
+#define TRACE_TICK_US	64
+#define REPLAY_START_MS	5000		// the firmware shows the menu ~4s after reset
+
+enum {
+	TRACE_INPUT_EDGE = 1,
+	TRACE_MENU_START = 2,
+	TRACE_ROW_EMIT = 3,
+	TRACE_MENU_END = 4,
+	TRACE_UART_IDLE = 5,
+	TRACE_LOST = 6,
+};
+
+static const char *event_names[] = { "?", "INPUT_EDGE", "MENU_START", "ROW_EMIT", "MENU_END", "UART_IDLE", "LOST" };
+
+enum {
+	STAGE_POLL,			// input edge -> show_menu start
+	STAGE_COMPOSE,		// show_menu start -> first row queued
+	STAGE_RENDER,		// first row queued -> show_menu end
+	STAGE_DRAIN,		// show_menu end -> last byte loaded into UDR0
+	STAGE_TOTAL,		// input edge -> last byte loaded into UDR0
+	STAGE_COUNT
+};
+
+static const char *stage_names[STAGE_COUNT] = { "input->menu start", "menu start->row 0", "row 0->menu end", "menu end->uart idle", "input->uart idle" };
+
+typedef struct {
+	double *samples;
+	size_t count;
+	size_t size;
+} Stage;
+
+static Stage stages[STAGE_COUNT];
+
+static void stage_add(Stage *stage, double ms)
+{
+	if (stage->count == stage->size)
+	{
+		stage->size = stage->size ? stage->size * 2 : 64;
+		stage->samples = realloc(stage->samples, stage->size * sizeof(double));
+		if (!stage->samples)
+		{
+			perror("realloc");
+			exit(1);
+		}
+	}
+	stage->samples[stage->count++] = ms;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+static double percentile(const Stage *stage, double p)
+{
+	size_t index = (size_t)(p * (stage->count - 1) + 0.5);
+	return stage->samples[index];
+}
+
+int main(int argc, char **argv)
+{
+	FILE *capture;
+	const char *path = NULL;
+	int dump = 0;
+	int script = 0;
+	unsigned long long t_first = 0;
+	int have_first = 0;
+	double bucket_ms = 20.0;
+	unsigned char record[5];
+	int byte;
+	size_t fill = 0;
+	int first_tick = 1;
+	unsigned int last_tick = 0;
+	unsigned long long now = 0;		// unwrapped time in TRACE_TICK_US units
+	unsigned long long t_input = 0, t_start = 0, t_row0 = 0, t_end = 0;
+	int have_input = 0, have_start = 0, have_row0 = 0, have_end = 0;
+	unsigned long records = 0, lost = 0, no_input = 0;
+	
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-e")) dump = 1;
+		else if (!strcmp(argv[i], "-i")) script = 1;
+		else if (!strcmp(argv[i], "-b") && (i + 1 < argc)) bucket_ms = atof(argv[++i]);
+		else path = argv[i];
+	}
+	if (!path || (bucket_ms <= 0))
+	{
+		fprintf(stderr, "usage: %s [-e] [-b bucket_ms] [-i] capture.bin\n", argv[0]);
+		return 2;
+	}
+	capture = fopen(path, "rb");
+	if (!capture)
+	{
+		perror(path);
+		return 1;
+	}
+	if (script) printf("# recorded from %s\n", path);
+	
+	while ((byte = fgetc(capture)) != EOF)
+	{
+		// resynchronize on TRACE_SYNC
+		if ((fill == 0) && (byte != TRACE_SYNC)) continue;
+		record[fill++] = (unsigned char)byte;
+		if ((fill == 2) && ((record[1] < TRACE_INPUT_EDGE) || (record[1] > TRACE_LOST)))
+		{
+			fill = (record[1] == TRACE_SYNC) ? 1 : 0;
+			if (fill) record[0] = TRACE_SYNC;
+			continue;
+		}
+		if (fill < 5) continue;
+		fill = 0;
+		records++;
+		
+		unsigned char id = record[1];
+		unsigned char arg = record[2];
+		unsigned int tick = record[3] | (record[4] << 8);
+		
+		if (first_tick) first_tick = 0;
+		else now += (tick - last_tick) & 0xFFFF;
+		last_tick = tick;
+		
+		if (dump) printf("%12.3f ms  %-10s %3u\n", now * TRACE_TICK_US / 1000.0, event_names[id], arg);
+		if (script)
+		{
+			if (id != TRACE_INPUT_EDGE) continue;
+			if (!have_first)
+			{
+				t_first = now;
+				have_first = 1;
+			}
+			printf("%llu %02X\n", REPLAY_START_MS + (now - t_first) * TRACE_TICK_US / 1000, arg);
+			continue;
+		}
+		
+		switch (id)
+		{
+			case TRACE_INPUT_EDGE:
+				if (!have_input && !have_start)
+				{
+					t_input = now;
+					have_input = 1;
+				}
+				break;
+			case TRACE_MENU_START:
+				t_start = now;
+				have_start = 1;
+				have_row0 = 0;
+				have_end = 0;
+				break;
+			case TRACE_ROW_EMIT:
+				if (have_start && !have_row0 && (arg == 0))
+				{
+					t_row0 = now;
+					have_row0 = 1;
+				}
+				break;
+			case TRACE_MENU_END:
+				if (have_start)
+				{
+					t_end = now;
+					have_end = 1;
+				}
+				break;
+			case TRACE_UART_IDLE:
+				if (have_end)
+				{
+					double us = TRACE_TICK_US / 1000.0;
+					if (have_input)
+					{
+						stage_add(&stages[STAGE_POLL], (t_start - t_input) * us);
+						stage_add(&stages[STAGE_TOTAL], (now - t_input) * us);
+					} else {
+						no_input++;
+					}
+					if (have_row0)
+					{
+						stage_add(&stages[STAGE_COMPOSE], (t_row0 - t_start) * us);
+						stage_add(&stages[STAGE_RENDER], (t_end - t_row0) * us);
+					}
+					stage_add(&stages[STAGE_DRAIN], (now - t_end) * us);
+					have_input = have_start = have_row0 = have_end = 0;
+				}
+				break;
+			case TRACE_LOST:
+				// interaction in progress is not complete, drop it
+				lost += arg;
+				have_input = have_start = have_row0 = have_end = 0;
+				break;
+		}
+	}
+	fclose(capture);
+	if (script) return 0;
+	
+	printf("records: %lu, lost: %lu, frames without input edge: %lu\n\n", records, lost, no_input);
+	printf("%-22s %7s %9s %9s %9s %9s %9s\n", "stage [ms]", "count", "min", "avg", "p50", "p95", "max");
+	for (int s = 0; s < STAGE_COUNT; s++)
+	{
+		Stage *stage = &stages[s];
+		double sum = 0;
+		
+		if (!stage->count)
+		{
+			printf("%-22s %7d\n", stage_names[s], 0);
+			continue;
+		}
+		qsort(stage->samples, stage->count, sizeof(double), compare_double);
+		for (size_t i = 0; i < stage->count; i++) sum += stage->samples[i];
+		printf("%-22s %7zu %9.2f %9.2f %9.2f %9.2f %9.2f\n", stage_names[s], stage->count, stage->samples[0], 
+			sum / stage->count, percentile(stage, 0.5), percentile(stage, 0.95), stage->samples[stage->count - 1]);
+	}
+	
+	// histogram of input to last byte latency
+	Stage *total = &stages[STAGE_TOTAL];
+	if (total->count)
+	{
+		size_t buckets = (size_t)(total->samples[total->count - 1] / bucket_ms) + 1;
+		size_t *histogram = calloc(buckets, sizeof(size_t));
+		size_t peak = 0;
+		
+		if (!histogram)
+		{
+			perror("calloc");
+			return 1;
+		}
+		for (size_t i = 0; i < total->count; i++) histogram[(size_t)(total->samples[i] / bucket_ms)]++;
+		for (size_t b = 0; b < buckets; b++) if (histogram[b] > peak) peak = histogram[b];
+		printf("\ninput->uart idle histogram\n");
+		for (size_t b = 0; b < buckets; b++)
+		{
+			int bar = (int)(histogram[b] * 50 / peak);
+			printf("%7.1f - %7.1f ms %6zu |%.*s\n", b * bucket_ms, (b + 1) * bucket_ms, histogram[b], bar, 
+				"##################################################");
+		}
+		free(histogram);
+	}
+	for (int s = 0; s < STAGE_COUNT; s++) free(stages[s].samples);
+	return 0;
+}